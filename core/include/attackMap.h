@@ -0,0 +1,71 @@
+#ifndef ATTACK_MAP_H
+#define ATTACK_MAP_H
+
+#include "position.h"
+
+using namespace std;
+
+/**
+ * @class AttackMap
+ * @brief Per-side attacked squares and attacker counts, kept up to date move by move.
+ */
+class AttackMap {
+public:
+    /**
+     * @brief Default constructor, no square is attacked.
+     */
+    AttackMap();
+
+    /**
+     * @brief Recomputes the attack map of a position from scratch.
+     * @param pos The position.
+     */
+    void compute(const Position& pos);
+
+    /**
+     * @brief Updates the attack map after a move, only touching the pieces whose attacks changed.
+     * @param before The position the attack map currently describes.
+     * @param after The position after the move.
+     */
+    void update(const Position& before, const Position& after);
+
+    /**
+     * @brief Checks if a square is attacked by a side.
+     * @param square The square to check.
+     * @param by The attacking side.
+     * @return True if the square is attacked, false otherwise.
+     */
+    bool isAttacked(int square, Color by) const { return attacked[by] & squareBB(square); }
+
+    /**
+     * @brief Returns the number of pieces of a side attacking a square.
+     */
+    int attackerCount(int square, Color by) const { return counts[by][square]; }
+
+    /**
+     * @brief Returns all squares attacked by a side.
+     */
+    Bitboard attacks(Color by) const { return attacked[by]; }
+
+private:
+    uint8_t counts[COLOR_NB][64]; // Number of attackers of each side on each square
+    Bitboard attacked[COLOR_NB]; // Squares with at least one attacker of each side
+
+    /**
+     * @brief Adds or removes the attacks of the piece on a square.
+     * @param pos The position the piece stands in.
+     * @param square The square of the piece.
+     * @param delta +1 to add the attacks, -1 to remove them.
+     */
+    void addPiece(const Position& pos, int square, int delta);
+};
+
+/**
+ * @brief Returns the squares attacked by the piece on a square.
+ * @param pos The position.
+ * @param square The occupied square.
+ * @return The attacked squares.
+ */
+Bitboard pieceAttacks(const Position& pos, int square);
+
+#endif
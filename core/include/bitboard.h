@@ -0,0 +1,130 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <array>
+#include "types.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PEXT_SUPPORTED
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H_BB = FILE_A_BB << 7;
+constexpr Bitboard RANK_1_BB = 0xFFULL;
+constexpr Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+// Tables built at compile time
+extern const array<Bitboard, 64> KnightAttacks; // Knight attacks from each square
+extern const array<Bitboard, 64> KingAttacks; // King attacks from each square
+extern const array<array<Bitboard, 64>, COLOR_NB> PawnAttacks; // Pawn captures from each square for each side
+extern const array<array<Bitboard, 64>, 64> BetweenBB; // Squares strictly between two aligned squares
+extern const array<array<Bitboard, 64>, 64> LineBB; // Full board line through two aligned squares
+extern const array<array<char, 3>, 64> SquareNames; // Name of each square, e.g. "e4"
+
+/**
+ * @brief Fills the sliding attack tables. Must be called once before any position is used.
+ */
+void initBitboards();
+
+/**
+ * @brief Returns whether slider lookups index their tables with the BMI2 PEXT instruction.
+ */
+bool usingPext();
+
+#if defined(PEXT_SUPPORTED) && !defined(__BMI2__)
+/**
+ * @brief Out of line PEXT for builds that only detect BMI2 at runtime.
+ */
+uint64_t pextRuntime(uint64_t value, uint64_t mask);
+#endif
+
+/**
+ * @struct Magic
+ * @brief Lookup data for the sliding attacks of one piece on one square.
+ */
+struct Magic {
+    Bitboard mask; // Relevant occupancy, excluding board edges
+    Bitboard magic; // Multiplier mapping occupancies to unique indices
+    Bitboard* attacks; // Attack table for this square
+    unsigned shift; // 64 minus the number of relevant bits
+    bool pext; // Index the table with PEXT instead of the magic multiplier
+
+    unsigned index(Bitboard occupied) const {
+#if defined(__BMI2__)
+        if (pext) return unsigned(_pext_u64(occupied, mask));
+#elif defined(PEXT_SUPPORTED)
+        if (pext) return unsigned(pextRuntime(occupied, mask));
+#endif
+        return unsigned(((occupied & mask) * magic) >> shift);
+    }
+};
+
+extern Magic RookMagics[64]; // Rook lookup data for each square
+extern Magic BishopMagics[64]; // Bishop lookup data for each square
+
+/**
+ * @brief Returns the attacks of a rook on a square given the board occupancy.
+ * @param square The square of the rook.
+ * @param occupied The occupied squares.
+ * @return The attacked squares.
+ */
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+    const Magic& m = RookMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+/**
+ * @brief Returns the attacks of a bishop on a square given the board occupancy.
+ * @param square The square of the bishop.
+ * @param occupied The occupied squares.
+ * @return The attacked squares.
+ */
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+    const Magic& m = BishopMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+constexpr Bitboard squareBB(int square) { return 1ULL << square; }
+
+/**
+ * @brief Returns the name of a square, e.g. "e4", without building a string.
+ */
+inline const char* squareName(int square) { return SquareNames[square].data(); }
+
+constexpr int popCount(Bitboard b) { return __builtin_popcountll(b); }
+
+inline int lsb(Bitboard b) { return __builtin_ctzll(b); }
+
+inline int msb(Bitboard b) { return 63 - __builtin_clzll(b); }
+
+inline bool moreThanOne(Bitboard b) { return b & (b - 1); }
+
+/**
+ * @brief Moves every square of a bitboard one step, dropping squares that would wrap around the board.
+ * @tparam Step The square offset of the step: 8 or -8 along a file, 7, 9, -7 or -9 along a diagonal.
+ */
+template <int Step>
+constexpr Bitboard shift(Bitboard b) {
+    static_assert(Step == 8 || Step == -8 || Step == 7 || Step == 9 || Step == -7 || Step == -9, "Unsupported step");
+    return Step == 8 ? b << 8
+         : Step == -8 ? b >> 8
+         : Step == 9 ? (b & ~FILE_H_BB) << 9
+         : Step == 7 ? (b & ~FILE_A_BB) << 7
+         : Step == -7 ? (b & ~FILE_H_BB) >> 7
+         : (b & ~FILE_A_BB) >> 9;
+}
+
+/**
+ * @brief Removes the least significant bit from a bitboard.
+ * @return The square of the removed bit.
+ */
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef ENGINE_POOL_H
+#define ENGINE_POOL_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include "position.h"
+#include "engineProcess.h"
+#include "uci.h"
+
+using namespace std;
+
+class EnginePool;
+
+const int POOL_HANDSHAKE_TIMEOUT_MS = 10000; // Time an engine gets to answer uci, isready or stop
+const int POOL_SEARCH_TIMEOUT_MS = 60000; // Time a search gets before it is stopped
+const int POOL_POLL_MS = 10; // How often a running search checks whether it was cancelled
+
+/**
+ * @struct EngineOptions
+ * @brief How the engines of a pool are started and set up.
+ */
+struct EngineOptions {
+    string path; // Executable of the engine
+    vector<string> args; // Arguments of the engine
+    int threads = 1; // Value of the Threads option of every engine
+    int hashMb = 16; // Value of the Hash option of every engine, in megabytes
+    int depth = 10; // Depth searched for jobs that set no limits
+};
+
+/**
+ * @struct EngineJobOptions
+ * @brief How one job wants its engine set up, on top of the pool's options.
+ */
+struct EngineJobOptions {
+    map<string, string> uciOptions; // Options sent with setoption before the search, only when their value changed
+    bool ponder = false; // Whether the engine ponders on the expected reply until the client's next job
+    bool newGame = false; // Whether the job starts a new game, so ucinewgame is sent even for the same client
+};
+
+/**
+ * @struct EngineResult
+ * @brief The answer to one job, with where its time went.
+ */
+struct EngineResult {
+    Move move = MOVE_NONE; // Best move, MOVE_NONE if there is none or the job was cancelled
+    Move ponder = MOVE_NONE; // Reply the engine expects, MOVE_NONE if it gave none
+    double queueWaitMs = 0; // Time from submission until an engine took the job
+    double searchMs = 0; // Time the engine spent on the job
+    int engine = -1; // Index of the engine that searched, -1 if none did
+};
+
+/**
+ * @struct EngineJobState
+ * @brief State of one job, shared between its handle and the pool.
+ */
+struct EngineJobState {
+    int client; // Who submitted the job, jobs are shared out fairly between clients
+    Position start; // Position the game started from
+    vector<Move> moves; // Moves of the game played from start
+    Position position; // Position to search, start with moves played
+    SearchLimits limits; // Bounds of the search
+    EngineJobOptions options; // Engine setup the job wants
+    chrono::steady_clock::time_point submitted; // When the job was queued
+    promise<EngineResult> result; // Set once the job is searched or dropped
+    atomic<bool> cancelled{false}; // Set by cancel, checked while the job is searched
+    atomic<EnginePool*> queuedIn{nullptr}; // Pool whose queue holds the job, nullptr once an engine took it or it was answered
+};
+
+/**
+ * @class EngineJob
+ * @brief Handle to a job of an engine pool. Copies refer to the same job.
+ */
+class EngineJob {
+public:
+    EngineJob() = default;
+    EngineJob(shared_ptr<EngineJobState> state) : state(state), result(state->result.get_future().share()) {}
+
+    /**
+     * @brief Returns whether the handle refers to a job.
+     */
+    bool valid() const { return state != nullptr; }
+
+    /**
+     * @brief Returns whether the result is available, without blocking.
+     */
+    bool ready() const { return state && result.wait_for(chrono::seconds(0)) == future_status::ready; }
+
+    /**
+     * @brief Waits for the result.
+     * @return The result, with MOVE_NONE as its move if the job was cancelled.
+     */
+    EngineResult get() const { return state ? result.get() : EngineResult(); }
+
+    /**
+     * @brief Cancels the job. A queued job is dropped and answered at once, a running search is stopped.
+     */
+    void cancel();
+
+private:
+    shared_ptr<EngineJobState> state; // Shared with the pool
+    shared_future<EngineResult> result; // Result of the job
+};
+
+/**
+ * @struct EnginePoolStats
+ * @brief Totals over all jobs a pool finished.
+ */
+struct EnginePoolStats {
+    uint64_t searched = 0; // Jobs an engine answered
+    uint64_t cancelled = 0; // Jobs cancelled before or during their search
+    double totalQueueWaitMs = 0; // Sum of the queue waits of searched jobs
+    double maxQueueWaitMs = 0; // Longest queue wait of a searched job
+    double totalSearchMs = 0; // Sum of the search times of searched jobs
+    uint64_t ponderHits = 0; // Jobs that continued a ponder search with ponderhit
+    uint64_t ponderMisses = 0; // Ponder searches stopped for another position or client, new games aside
+};
+
+/**
+ * @class EnginePool
+ * @brief A fixed set of warmed up UCI engine processes shared by many boards, analyses or bots.
+ *
+ * Jobs wait in one queue per client and engines take them round robin between clients,
+ * so a client submitting many jobs cannot starve the others. Each engine has its own worker thread.
+ * An engine pondering for a client keeps that client's next job, unless no other engine is free.
+ */
+class EnginePool {
+public:
+    EnginePool();
+    ~EnginePool();
+
+    EnginePool(const EnginePool&) = delete;
+    EnginePool& operator=(const EnginePool&) = delete;
+
+    /**
+     * @brief Starts the engines and waits until all of them are set up, stopping the engines started before.
+     * @param options How to start and set up every engine.
+     * @param count The number of engines.
+     * @return True if every engine started, false otherwise. The engines that started are kept.
+     */
+    bool start(const EngineOptions& options, int count);
+
+    /**
+     * @brief Stops the engines. Queued jobs are answered with MOVE_NONE.
+     */
+    void stop();
+
+    /**
+     * @brief Returns the number of running engines.
+     */
+    int size() const;
+
+    /**
+     * @brief Queues a search for the position a game reached.
+     * @param client Who submits the job, e.g. a board or bot ID.
+     * @param start The position the game started from.
+     * @param moves The moves of the game played from start.
+     * @param limits The bounds of the search, the pool's depth if they set none.
+     * @param jobOptions The engine setup the job wants.
+     * @return A handle to poll, wait on or cancel.
+     */
+    EngineJob submit(int client, const Position& start, const vector<Move>& moves, SearchLimits limits = {},
+                     const EngineJobOptions& jobOptions = {});
+
+    /**
+     * @brief Returns the totals over the jobs finished so far.
+     */
+    EnginePoolStats getStats() const;
+
+private:
+    /**
+     * @struct Engine
+     * @brief One engine process and the worker thread feeding it.
+     */
+    struct Engine {
+        EngineProcess process; // The engine process
+        thread worker; // Takes jobs for this engine
+        int lastClient = -1; // Client of the last job, the hash table is cleared when it changes
+        map<string, string> uciOptions; // Option values sent since the engine started
+        bool pondering = false; // Whether a go ponder search is running, written under queueMutex
+        int ponderClient = -1; // Client the ponder search is for, written under queueMutex
+        Key ponderKey = 0; // Key of the position the ponder search expects the client's next job to have
+        string ponderGo; // Go command of the search the ponder search continues as
+    };
+
+    EngineOptions options; // How the engines were started, written under queueMutex while no worker runs
+    vector<unique_ptr<Engine>> engines; // The engines, guarded by queueMutex
+    mutable mutex queueMutex; // Guards engines, queues, turns and stats
+    condition_variable jobReady; // Wakes the workers for a new job or to stop
+    map<int, deque<shared_ptr<EngineJobState>>> queues; // Waiting jobs by client, oldest first
+    deque<int> turns; // Clients with waiting jobs, in the order they are served
+    int idle = 0; // Workers waiting for a job without pondering
+    atomic<bool> stopping; // Tells the workers to exit and running searches to stop
+    EnginePoolStats stats; // Totals over finished jobs
+
+    /**
+     * @brief Starts an engine and sets its options.
+     * @return True if the engine answered, false otherwise.
+     */
+    bool warmUp(Engine& engine);
+
+    friend class EngineJob;
+
+    /**
+     * @brief Takes a job out of its client's queue and answers it with MOVE_NONE, if it is still queued.
+     */
+    void dropJob(const shared_ptr<EngineJobState>& job);
+
+    /**
+     * @brief Waits for the next job in round robin order between clients, reading a ponder search's output meanwhile.
+     * @return The job, or nullptr once the pool is stopping.
+     */
+    shared_ptr<EngineJobState> takeJob(Engine& engine);
+
+    /**
+     * @brief Returns whether an engine may take a client's job. Called with queueMutex held.
+     */
+    bool mayTake(const Engine& engine, int client) const;
+
+    /**
+     * @brief Takes and searches jobs on one engine until the pool stops.
+     */
+    void workerLoop(Engine& engine, int index);
+
+    /**
+     * @brief Searches one job on an engine.
+     * @return The best move text, empty if there is none, the search failed or the job was cancelled.
+     */
+    string search(Engine& engine, EngineJobState& job, string& ponder);
+
+    /**
+     * @brief Starts a ponder search on the reply the engine expects to its best move.
+     */
+    void startPondering(Engine& engine, const EngineJobState& job, const string& best, const string& reply);
+
+    /**
+     * @brief Stops a ponder search and waits for its bestmove.
+     */
+    void stopPondering(Engine& engine);
+
+    /**
+     * @brief Reads a ponder search's output so the engine never blocks on a full pipe.
+     * @return Whether the ponder search is still running.
+     */
+    bool drainPonderOutput(Engine& engine);
+
+    /**
+     * @brief Sends isready and waits for readyok.
+     */
+    bool waitReady(Engine& engine);
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef ENGINE_PROCESS_H
+#define ENGINE_PROCESS_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <sys/types.h>
+
+using namespace std;
+
+const size_t ENGINE_BUFFER_SIZE = 1 << 16; // Bytes of engine output buffered before lines are taken out, a power of two
+
+/**
+ * @brief How waiting for the end of a UCI search ended.
+ */
+enum SearchOutcome {
+    SEARCH_FINISHED, // A bestmove line was read, possibly after stop was sent
+    SEARCH_EXITED, // The engine exited before it answered
+    SEARCH_HUNG // The engine did not answer stop in time and was stopped
+};
+
+/**
+ * @class EngineProcess
+ * @brief A child process spoken to line by line over its standard input and output, such as a UCI engine.
+ *
+ * The child gets its own pipe for each direction. Output is read without blocking into a ring buffer
+ * and handed out as whole lines, and every read takes a timeout so a hung engine cannot hang the caller.
+ */
+class EngineProcess {
+public:
+    EngineProcess();
+    ~EngineProcess();
+
+    EngineProcess(const EngineProcess&) = delete;
+    EngineProcess& operator=(const EngineProcess&) = delete;
+
+    /**
+     * @brief Starts the process, stopping the one running before.
+     * @param path The path of the executable.
+     * @param args The arguments after the program name.
+     * @return True if the process was started, false otherwise.
+     */
+    bool start(const string& path, const vector<string>& args = {});
+
+    /**
+     * @brief Stops the process and reaps it. Closes its input first so it can quit on its own,
+     * then escalates to SIGTERM and SIGKILL.
+     * @param graceMs How long to wait at each step before escalating.
+     */
+    void stop(int graceMs = 500);
+
+    /**
+     * @brief Checks if the process is still running, reaping it if it exited.
+     * @return True if the process is running, false otherwise.
+     */
+    bool running();
+
+    /**
+     * @brief Writes a line to the process's input.
+     * @param line The line, without the newline.
+     * @return True if the whole line was written, false otherwise.
+     */
+    bool send(const string& line);
+
+    /**
+     * @brief Takes the next line of output, waiting for it at most a given time.
+     * @param line Set to the line, without the newline.
+     * @param timeoutMs The time to wait in milliseconds, 0 to only take buffered output.
+     * @return True if a line was read, false on timeout or if the process closed its output.
+     */
+    bool readLine(string& line, int timeoutMs);
+
+    /**
+     * @brief Reads lines until one starts with a prefix, discarding the others.
+     * @param prefix The prefix to wait for, e.g. "bestmove".
+     * @param line Set to the matching line.
+     * @param timeoutMs The total time to wait in milliseconds.
+     * @return True if a matching line was read, false on timeout or if the process closed its output.
+     */
+    bool waitFor(const string& prefix, string& line, int timeoutMs);
+
+    /**
+     * @brief Reads the output of a running UCI search until its bestmove line. Once the search should end
+     * or runs out of time, stop is sent and the bestmove it is answered with is still read, so it cannot
+     * be taken for the answer to the next search.
+     * @param line Set to the bestmove line.
+     * @param shouldStop Asked every poll whether the search should end early.
+     * @param timeoutMs The time the search gets before it is stopped.
+     * @param stopTimeoutMs The time the engine gets to answer stop before the process is stopped.
+     * @param pollMs How often shouldStop is asked.
+     * @return How the wait ended.
+     */
+    SearchOutcome waitBestMove(string& line, const function<bool()>& shouldStop, int timeoutMs, int stopTimeoutMs, int pollMs);
+
+private:
+    pid_t pid; // Process ID of the child, or -1
+    int toChild; // Write end of the child's standard input, or -1
+    int fromChild; // Read end of the child's standard output, or -1
+    char buffer[ENGINE_BUFFER_SIZE]; // Ring buffer of output not yet taken as lines
+    size_t head; // Total bytes written into the ring buffer
+    size_t tail; // Total bytes taken out of the ring buffer
+    size_t scanned; // Bytes from tail already searched for a newline
+    bool outputClosed; // Whether the child closed its output
+
+    /**
+     * @brief Moves whatever output is available into the ring buffer without blocking.
+     * @return False if the process closed its output, true otherwise.
+     */
+    bool fill();
+
+    /**
+     * @brief Takes a complete line out of the ring buffer if there is one.
+     */
+    bool takeLine(string& line);
+
+    /**
+     * @brief Closes the pipes to the child.
+     */
+    void closePipes();
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef EPD_READER_H
+#define EPD_READER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include "position.h"
+
+using namespace std;
+
+/**
+ * @struct EpdRecord
+ * @brief One parsed line of an EPD file.
+ */
+struct EpdRecord {
+    Position position; // Position described by the FEN fields of the line
+    const char* operations; // Text after the FEN fields, such as "bm e4; id \"x\";", pointing into the mapped file
+    uint32_t operationsLength; // Length of the operations text
+    uint64_t offset; // Byte offset of the line in the file
+};
+
+/**
+ * @struct EpdBatch
+ * @brief Lines of an EPD file claimed together by one worker. Reused from batch to batch.
+ */
+struct EpdBatch {
+    vector<EpdRecord> records; // Lines that parsed
+    size_t invalid = 0; // Lines that are not EPD, skipped
+    size_t bytes = 0; // Bytes of the file the batch covers
+};
+
+/**
+ * @class EpdReader
+ * @brief Streams the positions of a memory mapped EPD file out in batches, from any number of threads.
+ *
+ * Lines are split and board fields validated with SIMD character classification (SSE2 or NEON)
+ * when the build targets support it, and with a per byte lookup table otherwise.
+ */
+class EpdReader {
+public:
+    /**
+     * @brief Default constructor, no file is open.
+     * @param batchBytes Approximate number of bytes of the file per batch.
+     */
+    explicit EpdReader(size_t batchBytes = 1 << 20);
+
+    ~EpdReader();
+
+    EpdReader(const EpdReader&) = delete;
+    EpdReader& operator=(const EpdReader&) = delete;
+
+    /**
+     * @brief Maps a file and rewinds to its start.
+     * @param path The path of the EPD file.
+     * @return True if the file was mapped, false otherwise.
+     */
+    bool open(const string& path);
+
+    /**
+     * @brief Unmaps the open file, if any.
+     */
+    void close();
+
+    /**
+     * @brief Restarts batch handout at the start of the file.
+     */
+    void rewind() { cursor = 0; }
+
+    /**
+     * @brief Returns the size of the open file in bytes.
+     */
+    size_t size() const { return length; }
+
+    /**
+     * @brief Selects SIMD or scalar character classification, e.g. to compare them.
+     * @param enabled Whether to use SIMD. Ignored if the build has no SIMD support.
+     */
+    void setSimd(bool enabled) { simd = enabled && simdAvailable(); }
+
+    /**
+     * @brief Returns whether the build has SIMD character classification.
+     */
+    static bool simdAvailable();
+
+    /**
+     * @brief Claims and parses the next batch of whole lines. Safe to call from several threads.
+     * @param batch Filled with the lines of the batch, replacing its previous contents.
+     * @return True if a batch was claimed, false once the whole file was handed out.
+     */
+    bool nextBatch(EpdBatch& batch);
+
+    /**
+     * @brief Hands all remaining batches to a pool of worker threads.
+     * @param threads The number of worker threads, the calling thread being one of them.
+     * @param handler Called for every batch, concurrently from the workers.
+     */
+    void run(int threads, const function<void(const EpdBatch&)>& handler);
+
+    /**
+     * @brief Counts the lines of the open file and the lines whose board field is well formed,
+     * without parsing positions. Measures the character classification alone.
+     * @param validBoards Set to the number of lines with a well formed board field.
+     * @return The number of non-empty lines.
+     */
+    size_t scan(size_t& validBoards) const;
+
+private:
+    const char* data; // Mapped file contents
+    size_t length; // Size of the mapped file
+    size_t batchBytes; // Approximate bytes per batch
+    atomic<size_t> cursor; // Offset of the next unclaimed batch
+    bool simd; // Whether to classify characters with SIMD
+
+    /**
+     * @brief Returns the offset of the first line starting at or after an offset.
+     */
+    size_t lineStart(size_t offset) const;
+};
+
+#endif
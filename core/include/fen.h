@@ -0,0 +1,15 @@
+#ifndef FEN_H
+#define FEN_H
+
+#include <string>
+#include "position.h"
+
+using namespace std;
+
+/**
+ * @brief Prints the FEN string to the console.
+ * @param fen The FEN string to print.
+ */
+void printFEN(const string& fen);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef GAME_STATUS_H
+#define GAME_STATUS_H
+
+#include <string>
+#include <vector>
+#include "position.h"
+#include "attackMap.h"
+
+using namespace std;
+
+/**
+ * @brief Why a game ended in a draw.
+ */
+enum DrawReason : uint8_t {
+    NO_DRAW,
+    DRAW_STALEMATE,
+    DRAW_FIFTY_MOVES,
+    DRAW_INSUFFICIENT_MATERIAL,
+    DRAW_REPETITION
+};
+
+/**
+ * @struct GameStatus
+ * @brief Result of the rule checks for one position, computed once per move.
+ */
+struct GameStatus {
+    Color sideToMove = WHITE; // Side the status applies to
+    bool check = false; // Whether the side to move is in check
+    bool checkmate = false; // Whether the side to move is checkmated
+    DrawReason draw = NO_DRAW; // Why the game is drawn, if it is
+
+    bool stalemate() const { return draw == DRAW_STALEMATE; }
+    bool gameOver() const { return checkmate || draw != NO_DRAW; }
+};
+
+/**
+ * @brief Checks if a position occurred for the third time.
+ * @param pos The position.
+ * @param history Keys of all positions of the game by ply, ending with the key of pos.
+ * @return True if the position occurred at least three times, false otherwise.
+ */
+bool isThreefoldRepetition(const Position& pos, const vector<Key>& history);
+
+/**
+ * @brief Computes the game status of a position.
+ * @param pos The position.
+ * @param history Keys of all positions of the game by ply, ending with the key of pos.
+ * @param attacks Attack map of pos, if one is kept. Check and castling are then looked up in it.
+ * @return The game status.
+ */
+GameStatus computeGameStatus(const Position& pos, const vector<Key>& history = {}, const AttackMap* attacks = nullptr);
+
+/**
+ * @brief Returns a readable description of a draw reason.
+ */
+string drawReasonToString(DrawReason reason);
+
+#endif
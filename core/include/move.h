@@ -0,0 +1,63 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <string>
+#include "types.h"
+
+using namespace std;
+
+/**
+ * @brief Special move kinds stored in the top bits of a Move.
+ */
+enum MoveFlag : uint16_t {
+    NORMAL_MOVE = 0,
+    PROMOTION_MOVE = 1 << 14,
+    EN_PASSANT_MOVE = 2 << 14,
+    CASTLING_MOVE = 3 << 14
+};
+
+/**
+ * @class Move
+ * @brief A move packed into 16 bits: source (bits 0-5), destination (6-11), promotion piece (12-13) and flag (14-15).
+ */
+class Move {
+public:
+    Move() : data(0) {}
+    Move(int from, int to, MoveFlag flag=NORMAL_MOVE, PieceType promotion=KNIGHT)
+        : data(uint16_t(from | (to << 6) | ((promotion - KNIGHT) << 12) | flag)) {}
+
+    int from() const { return data & 0x3F; }
+    int to() const { return (data >> 6) & 0x3F; }
+    MoveFlag flag() const { return MoveFlag(data & (3 << 14)); }
+    PieceType promotion() const { return (flag() == PROMOTION_MOVE) ? PieceType(KNIGHT + ((data >> 12) & 3)) : NO_PIECE_TYPE; }
+
+    /**
+     * @brief Returns the packed 16-bit value, e.g. to send the move over the network.
+     */
+    uint16_t raw() const { return data; }
+    static Move fromRaw(uint16_t raw) { Move move; move.data = raw; return move; }
+
+    bool isNone() const { return data == 0; }
+    bool operator==(const Move& other) const { return data == other.data; }
+    bool operator!=(const Move& other) const { return data != other.data; }
+
+    /**
+     * @brief Returns the move in UCI notation, e.g. "e7e8q".
+     */
+    string toString() const {
+        string result = {char('a' + fileOf(from())), char('1' + rankOf(from())), char('a' + fileOf(to())), char('1' + rankOf(to()))};
+        if (promotion() != NO_PIECE_TYPE) {
+            result += "pnbrqk"[promotion()];
+        }
+        return result;
+    }
+
+private:
+    uint16_t data; // Packed move
+};
+
+static_assert(sizeof(Move) == 2, "Move must stay packed into 16 bits");
+
+const Move MOVE_NONE; // No move, a1 to a1 is never a real move
+
+#endif
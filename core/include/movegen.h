@@ -0,0 +1,66 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include <string>
+#include "position.h"
+#include "attackMap.h"
+
+using namespace std;
+
+/**
+ * @struct MoveList
+ * @brief Fixed capacity list of moves, large enough for any legal position.
+ */
+struct MoveList {
+    Move moves[256]; // Generated moves
+    int count = 0; // Number of generated moves
+
+    void add(Move move) { moves[count++] = move; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+};
+
+/**
+ * @brief Builds a move between two squares, deriving its flag from the position.
+ * @param pos The position the move is played in.
+ * @param from The source square.
+ * @param to The destination square.
+ * @param promotion The piece a pawn promotes to when it reaches the last rank.
+ * @return The move.
+ */
+Move makeMove(const Position& pos, int from, int to, PieceType promotion=QUEEN);
+
+/**
+ * @brief Converts UCI notation such as "e2e4" or "e7e8q" to a move.
+ * @param pos The position the move is played in.
+ * @param text The move in UCI notation.
+ * @return The move, or MOVE_NONE if the text is not a move.
+ */
+Move parseUciMove(const Position& pos, const string& text);
+
+/**
+ * @brief Generates all moves for the side to move that follow the piece movement rules, ignoring king safety.
+ * @param pos The position.
+ * @param list The list to append the moves to.
+ */
+void generatePseudoLegalMoves(const Position& pos, MoveList& list);
+
+/**
+ * @brief Generates all legal moves for the side to move.
+ * @param pos The position.
+ * @param list The list to append the moves to.
+ * @param attacks Attack map of pos, if one is kept. Castling and check are then looked up in it instead of worked out.
+ */
+void generateLegalMoves(const Position& pos, MoveList& list, const AttackMap* attacks=nullptr);
+
+/**
+ * @brief Checks if the side to move has at least one legal move.
+ * @param pos The position.
+ * @param attacks Attack map of pos, if one is kept.
+ * @return True if a legal move exists, false otherwise.
+ */
+bool hasLegalMove(const Position& pos, const AttackMap* attacks=nullptr);
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <string>
+#include <cstring>
+#include <type_traits>
+#include "types.h"
+#include "bitboard.h"
+#include "move.h"
+
+using namespace std;
+
+const string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+const size_t FEN_BUFFER_SIZE = 128; // Buffer size Position::writeFen needs, the longest FEN plus terminator fits
+
+/**
+ * @struct UndoInfo
+ * @brief State a move destroys, recorded by makeMove so unmakeMove can restore it.
+ */
+struct UndoInfo {
+    PieceType captured; // Piece captured on the destination square, or NO_PIECE_TYPE
+    uint8_t castling; // Castling rights before the move
+    uint8_t ep; // En passant square before the move
+    uint16_t halfmove; // Halfmove clock before the move
+    MoveFlag flag; // Kind of the move, read from the board rather than the Move's flag bits
+    Key key; // Zobrist key before the move
+};
+
+/**
+ * @struct PackedPosition
+ * @brief Canonical 32 byte encoding of a position for network messages, result caches and snapshot files.
+ *
+ * Bytes 0-7 hold the occupancy bitboard, little endian. Bytes 8-23 hold one nibble per occupied square
+ * from a1 upwards, low nibble first, coded (color << 3) | piece type. Byte 24 holds the side to move in
+ * bit 0 and the castling rights in bits 1-4, byte 25 the en passant square or NO_SQUARE. Bytes 26-27 and
+ * 28-29 hold the halfmove clock and fullmove number, little endian. Bytes 30-31 are zero.
+ */
+struct PackedPosition {
+    uint8_t bytes[32];
+
+    bool operator==(const PackedPosition& other) const { return memcmp(bytes, other.bytes, sizeof(bytes)) == 0; }
+    bool operator!=(const PackedPosition& other) const { return !(*this == other); }
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+
+/**
+ * @class Position
+ * @brief Bitboard representation of a chess position used for all rule decisions.
+ */
+class Position {
+public:
+    /**
+     * @brief Default constructor, creates an empty board with white to move.
+     */
+    Position();
+
+    /**
+     * @brief Sets the position from FEN text without allocating.
+     * @param fen The FEN text. It does not need to be null terminated.
+     * @param length The number of characters in the text.
+     * @return True if the FEN text was parsed, false otherwise. The position is left unchanged on failure.
+     */
+    bool set(const char* fen, size_t length);
+
+    /**
+     * @brief Sets the position from a FEN string.
+     * @param fen The FEN string.
+     * @return True if the FEN string was parsed, false otherwise. The position is left unchanged on failure.
+     */
+    bool set(const string& fen) { return set(fen.data(), fen.size()); }
+
+    /**
+     * @brief Writes the FEN string of the position into a caller provided buffer without allocating.
+     * @param buffer The buffer, null terminated on success.
+     * @param size The size of the buffer, at least FEN_BUFFER_SIZE.
+     * @return The length of the FEN string, or 0 if the buffer is too small.
+     */
+    size_t writeFen(char* buffer, size_t size) const;
+
+    /**
+     * @brief Returns the FEN string of the position.
+     * @return The FEN string.
+     */
+    string fen() const;
+
+    /**
+     * @brief Encodes the position into its packed form. Equal positions, clocks included, pack to equal bytes.
+     * @param packed Filled with the encoding.
+     * @return True if the position was packed, false if it has more than 32 pieces.
+     */
+    bool pack(PackedPosition& packed) const;
+
+    /**
+     * @brief Sets the position from its packed form.
+     * @param packed The encoding.
+     * @return True if the encoding was valid, false otherwise, e.g. for non-zero padding.
+     */
+    bool unpack(const PackedPosition& packed);
+
+    Bitboard pieces() const { return byColor[WHITE] | byColor[BLACK]; }
+    Bitboard pieces(Color c) const { return byColor[c]; }
+    Bitboard pieces(PieceType pt) const { return byType[pt]; }
+    Bitboard pieces(Color c, PieceType pt) const { return byColor[c] & byType[pt]; }
+
+    /**
+     * @brief Returns the type of the piece on a square.
+     * @param square The square to look at.
+     * @return The piece type, or NO_PIECE_TYPE if the square is empty.
+     */
+    PieceType typeOn(int square) const;
+
+    /**
+     * @brief Returns the color of the piece on a square. Only meaningful for occupied squares.
+     * @param square The square to look at.
+     * @return The color of the piece.
+     */
+    Color colorOn(int square) const { return (byColor[BLACK] & squareBB(square)) ? BLACK : WHITE; }
+
+    bool empty(int square) const { return !(pieces() & squareBB(square)); }
+    Color sideToMove() const { return side; }
+    uint8_t castlingRights() const { return castling; }
+    int epSquare() const { return ep; }
+    int halfmoveClock() const { return halfmove; }
+    int fullmoveNumber() const { return fullmove; }
+
+    /**
+     * @brief Returns the Zobrist key of the position, kept up to date move by move.
+     * @return The key. Equal positions (pieces, side to move, castling and en passant) have equal keys.
+     */
+    Key key() const { return hash; }
+
+    /**
+     * @brief Returns the square of a side's king.
+     * @param c The side.
+     * @return The king square, or NO_SQUARE if the side has no king.
+     */
+    int kingSquare(Color c) const;
+
+    /**
+     * @brief Returns all pieces of both sides attacking a square.
+     * @param square The attacked square.
+     * @param occupied The occupancy used to block sliding pieces.
+     * @return The attacking pieces.
+     */
+    Bitboard attackersTo(int square, Bitboard occupied) const;
+
+    /**
+     * @brief Checks if a square is attacked by a side.
+     * @param square The square to check.
+     * @param by The attacking side.
+     * @return True if the square is attacked, false otherwise.
+     */
+    bool isAttacked(int square, Color by) const;
+
+    /**
+     * @brief Checks if a side's king is attacked.
+     * @param c The side to check.
+     * @return True if the king is in check, false otherwise.
+     */
+    bool inCheck(Color c) const;
+
+    /**
+     * @brief Returns the enemy pieces giving check to the side to move.
+     */
+    Bitboard checkers() const;
+
+    /**
+     * @brief Returns the pieces of the side to move that are pinned to their king.
+     */
+    Bitboard pinned() const;
+
+    /**
+     * @brief Checks if a pseudo-legal move keeps the mover's king safe, using precomputed masks.
+     * @param from The source square.
+     * @param to The destination square.
+     * @param pinnedPieces The result of pinned() for this position.
+     * @param checkingPieces The result of checkers() for this position.
+     * @return True if the king is not attacked after the move, false otherwise.
+     */
+    bool keepsKingSafe(int from, int to, Bitboard pinnedPieces, Bitboard checkingPieces) const;
+
+    /**
+     * @brief Checks if a move follows the movement rules for the side to move, ignoring king safety.
+     * @param from The source square.
+     * @param to The destination square.
+     * @return True if the move is pseudo-legal, false otherwise.
+     */
+    bool isPseudoLegal(int from, int to) const;
+
+    /**
+     * @brief Checks if a move is legal for the side to move.
+     * @param from The source square.
+     * @param to The destination square.
+     * @return True if the move is legal, false otherwise.
+     */
+    bool isLegal(int from, int to) const;
+
+    /**
+     * @brief Checks if a side may castle now: the right is kept, the path is empty and the king does not pass an attacked square.
+     * @tparam Us The castling side, instantiated for both colors.
+     * @param kingside True for kingside castling, false for queenside.
+     * @return True if castling is allowed, false otherwise.
+     */
+    template <Color Us>
+    bool canCastle(bool kingside) const;
+
+    /**
+     * @brief Checks if a side may castle now, taking the squares the enemy attacks from an attack map
+     * instead of working them out.
+     * @tparam Us The castling side, instantiated for both colors.
+     * @param kingside True for kingside castling, false for queenside.
+     * @param enemyAttacks All squares the other side attacks in this position.
+     * @return True if castling is allowed, false otherwise.
+     */
+    template <Color Us>
+    bool canCastle(bool kingside, Bitboard enemyAttacks) const;
+
+    /**
+     * @brief Checks if a king move is a castling move.
+     */
+    bool isCastling(int from, int to) const;
+
+    /**
+     * @brief Checks if a pawn move is an en passant capture.
+     */
+    bool isEnPassant(int from, int to) const;
+
+    /**
+     * @brief Applies a move to the position. The move is assumed to be legal.
+     * @param from The source square.
+     * @param to The destination square.
+     * @param promotion The piece a pawn promotes to when it reaches the last rank.
+     */
+    void applyMove(int from, int to, PieceType promotion=QUEEN);
+
+    /**
+     * @brief Applies a packed move to the position. The move is assumed to be legal.
+     * @param move The move.
+     */
+    void applyMove(Move move) { applyMove(move.from(), move.to(), move.promotion()); }
+
+    /**
+     * @brief Applies a move and records what is needed to take it back. The move is assumed to be legal.
+     * @param move The move. Castling, en passant and promotion are recognized from the board, so the flag may be unset.
+     * @param undo Filled with the state the move overwrites.
+     */
+    void makeMove(Move move, UndoInfo& undo);
+
+    /**
+     * @brief Takes back the last move made with makeMove.
+     * @param move The move that was made.
+     * @param undo The record makeMove filled for it.
+     */
+    void unmakeMove(Move move, const UndoInfo& undo);
+
+private:
+    Bitboard byType[PIECE_TYPE_NB]; // Pieces of each type for both sides
+    Bitboard byColor[COLOR_NB]; // Pieces of each side
+    Color side; // Side to move
+    uint8_t castling; // CastlingRights flags
+    uint8_t ep; // En passant target square or NO_SQUARE
+    uint16_t halfmove; // Halfmove clock for the fifty move rule
+    uint16_t fullmove; // Fullmove number
+    Key hash; // Zobrist key of the position
+
+    void putPiece(Color c, PieceType pt, int square);
+    void removePiece(int square);
+
+    /**
+     * @brief Returns the squares the king crosses when castling, including its source and destination,
+     * or 0 if the right is gone, a piece is missing or the squares between king and rook are occupied.
+     */
+    template <Color Us>
+    Bitboard castlingKingPath(bool kingside) const;
+
+    /**
+     * @brief Drops an en passant square no pawn can capture on and hashes the side, castling and en passant state.
+     * Called once the pieces are placed when setting up a position.
+     */
+    void finishSetup();
+
+    /**
+     * @brief Parses FEN text into this empty position, rejecting boards without 8 full ranks or one king per side,
+     * a side token other than w or b, and an en passant square on the wrong rank for the side to move.
+     * @return True if the FEN text was parsed, false otherwise, with the position half built.
+     */
+    bool parse(const char* fen, size_t length);
+};
+
+// Positions are snapshotted by plain copies, e.g. for undo records and background analysis threads
+static_assert(is_trivially_copyable<Position>::value, "Position must be copyable with memcpy");
+static_assert(sizeof(Position) < 100, "Position must stay small enough to copy per move");
+
+/**
+ * @brief Converts a square to its notation, e.g. 0 to "a1".
+ */
+string squareToNotation(int square);
+
+/**
+ * @brief Converts a notation such as "e4" to a square.
+ * @return The square, or NO_SQUARE if the notation is invalid.
+ */
+int notationToSquare(const string& notation);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <cstdint>
+
+using namespace std;
+
+typedef uint64_t Bitboard; // One bit per square, a1 = bit 0 and h8 = bit 63
+typedef uint64_t Key; // Zobrist hash identifying a position
+
+/**
+ * @brief Side of a piece or the side to move.
+ */
+enum Color : uint8_t {
+    WHITE,
+    BLACK,
+    COLOR_NB
+};
+
+/**
+ * @brief Kind of a chess piece.
+ */
+enum PieceType : uint8_t {
+    PAWN,
+    KNIGHT,
+    BISHOP,
+    ROOK,
+    QUEEN,
+    KING,
+    PIECE_TYPE_NB,
+    NO_PIECE_TYPE = PIECE_TYPE_NB
+};
+
+/**
+ * @brief Castling availability flags as stored in the position.
+ */
+enum CastlingRights : uint8_t {
+    NO_CASTLING = 0,
+    WHITE_OO = 1,
+    WHITE_OOO = 2,
+    BLACK_OO = 4,
+    BLACK_OOO = 8,
+    ALL_CASTLING = 15
+};
+
+const int NO_SQUARE = 64; // Sentinel for "no square" (e.g. no en passant target)
+
+constexpr Color operator~(Color c) { return Color(c ^ BLACK); }
+
+/**
+ * @brief Returns the name of a piece type, e.g. "knight", for asset paths and logging.
+ */
+inline const char* pieceTypeName(PieceType pt) {
+    static const char* const names[] = {"pawn", "knight", "bishop", "rook", "queen", "king", "none"};
+    return names[pt];
+}
+
+/**
+ * @brief Returns the name of a color, "white" or "black", for logging and the network protocol.
+ */
+inline const char* colorName(Color c) { return (c == WHITE) ? "white" : "black"; }
+
+constexpr int makeSquare(int file, int rank) { return rank * 8 + file; }
+constexpr int fileOf(int square) { return square & 7; }
+constexpr int rankOf(int square) { return square >> 3; }
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include <string>
+#include <vector>
+#include "position.h"
+
+using namespace std;
+
+/**
+ * @struct SearchLimits
+ * @brief What bounds a search. Zero fields are left out of the go command.
+ */
+struct SearchLimits {
+    int depth = 0; // Depth in plies
+    int moveTimeMs = 0; // Time to search in milliseconds
+};
+
+/**
+ * @brief Builds the UCI position command for a game, "position startpos" when it starts from the standard position.
+ * @param start The position the game started from.
+ * @param moves The moves played from start.
+ * @return The command, without a newline.
+ */
+string uciPositionCommand(const Position& start, const vector<Move>& moves);
+
+/**
+ * @brief Builds the UCI go command for search limits.
+ * @param limits The bounds of the search.
+ * @param ponder Whether the search is a ponder search.
+ * @return The command, without a newline.
+ */
+string uciGoCommand(const SearchLimits& limits, bool ponder=false);
+
+/**
+ * @brief Splits a "bestmove <move> [ponder <move>]" line.
+ * @param line The line read from the engine.
+ * @param best Set to the best move text, empty for "bestmove (none)".
+ * @param ponder Set to the expected reply, empty if the engine gave none.
+ * @return True if the line is a bestmove line, false otherwise.
+ */
+bool parseBestMove(const string& line, string& best, string& ponder);
+
+#endif
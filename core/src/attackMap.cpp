@@ -0,0 +1,74 @@
+#include "attackMap.h"
+#include <cstring>
+
+using namespace std;
+
+Bitboard pieceAttacks(const Position& pos, int square) {
+    switch (pos.typeOn(square)) {
+        case PAWN: return PawnAttacks[pos.colorOn(square)][square];
+        case KNIGHT: return KnightAttacks[square];
+        case BISHOP: return bishopAttacks(square, pos.pieces());
+        case ROOK: return rookAttacks(square, pos.pieces());
+        case QUEEN: return bishopAttacks(square, pos.pieces()) | rookAttacks(square, pos.pieces());
+        case KING: return KingAttacks[square];
+        default: return 0;
+    }
+}
+
+AttackMap::AttackMap() {
+    memset(counts, 0, sizeof(counts));
+    attacked[WHITE] = attacked[BLACK] = 0;
+}
+
+void AttackMap::addPiece(const Position& pos, int square, int delta) {
+    Color c = pos.colorOn(square);
+    Bitboard targets = pieceAttacks(pos, square);
+    while (targets) {
+        int target = popLsb(targets);
+        counts[c][target] += delta;
+        if (counts[c][target]) {
+            attacked[c] |= squareBB(target);
+        } else {
+            attacked[c] &= ~squareBB(target);
+        }
+    }
+}
+
+void AttackMap::compute(const Position& pos) {
+    *this = AttackMap();
+    Bitboard occupied = pos.pieces();
+    while (occupied) {
+        addPiece(pos, popLsb(occupied), 1);
+    }
+}
+
+void AttackMap::update(const Position& before, const Position& after) {
+    // Squares whose contents changed: source, destination, captured pawn and castling rook squares
+    Bitboard changed = 0;
+    for (int c = WHITE; c < COLOR_NB; ++c) {
+        for (int pt = PAWN; pt < PIECE_TYPE_NB; ++pt) {
+            changed |= before.pieces(Color(c), PieceType(pt)) ^ after.pieces(Color(c), PieceType(pt));
+        }
+    }
+
+    /**
+     * Sliders that stayed put only change their attacks if a ray reached one of the changed
+     * squares, since any square that opened or closed a ray is itself a changed square
+     */
+    Bitboard sliders = (before.pieces(BISHOP) | before.pieces(ROOK) | before.pieces(QUEEN)) & ~changed;
+    Bitboard affectedSliders = 0;
+    Bitboard squares = changed;
+    while (squares) {
+        affectedSliders |= before.attackersTo(popLsb(squares), before.pieces()) & sliders;
+    }
+
+    Bitboard removed = (before.pieces() & changed) | affectedSliders;
+    while (removed) {
+        addPiece(before, popLsb(removed), -1);
+    }
+
+    Bitboard added = (after.pieces() & changed) | affectedSliders;
+    while (added) {
+        addPiece(after, popLsb(added), 1);
+    }
+}
@@ -0,0 +1,244 @@
+#include "bitboard.h"
+
+using namespace std;
+
+Magic RookMagics[64];
+Magic BishopMagics[64];
+
+static Bitboard RookTable[0x19000]; // Rook attacks for every relevant occupancy of every square
+static Bitboard BishopTable[0x1480]; // Bishop attacks for every relevant occupancy of every square
+static bool pextEnabled = false;
+
+// Precomputed magic multipliers so no search is needed at startup
+static const Bitboard RookMagicNumbers[64] = {
+    0x1080004008801020ULL, 0x0840092002c03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000a001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021d00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000a0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000a00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040a00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xc100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000a0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040a00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04c1002414824001ULL, 0x020020000b001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084c0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+
+static const Bitboard BishopMagicNumbers[64] = {
+    0xa010041108003100ULL, 0x006082020a002900ULL, 0x6810010619200000ULL, 0x08281a0520000408ULL,
+    0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040a0210245280ULL, 0x000200210808a402ULL,
+    0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202c0ULL, 0x0100091401081000ULL,
+    0x8021011140000012ULL, 0x0810020804450400ULL, 0x208b0542109008a2ULL, 0x0080084a08040204ULL,
+    0x0040e2a80811244cULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010a040420220040ULL,
+    0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000a62048043004ULL, 0x280120048a015004ULL,
+    0x006090002a020814ULL, 0x44042000240800d0ULL, 0x01102800040a4400ULL, 0x1004080080220040ULL,
+    0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+    0x0024040500c05021ULL, 0x0088611002080200ULL, 0x0116080a00040020ULL, 0x4000020080080080ULL,
+    0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002e00ULL,
+    0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221c0400ULL, 0x0422014022009020ULL,
+    0x0210046102100c00ULL, 0xc004008082029102ULL, 0x00aa461801101200ULL, 0x0404080080201108ULL,
+    0x020542108c205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+    0x00004204850400c0ULL, 0x0200100410a42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+    0x2884804130100200ULL, 0x800c262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+    0x0104000012a02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL
+};
+
+/**
+ * @brief Returns the square reached by stepping from a square, or NO_SQUARE if it leaves the board.
+ */
+static constexpr int offsetSquare(int square, int fileStep, int rankStep) {
+    int file = fileOf(square) + fileStep;
+    int rank = rankOf(square) + rankStep;
+    if (file < 0 || file > 7 || rank < 0 || rank > 7) {
+        return NO_SQUARE;
+    }
+    return makeSquare(file, rank);
+}
+
+/**
+ * @brief Walks one direction from a square until the edge of the board or the first occupied square.
+ */
+static constexpr Bitboard rayAttacks(int square, Bitboard occupied, int fileStep, int rankStep) {
+    Bitboard attacks = 0;
+    int s = square;
+    while ((s = offsetSquare(s, fileStep, rankStep)) != NO_SQUARE) {
+        attacks |= squareBB(s);
+        if (occupied & squareBB(s)) {
+            break;
+        }
+    }
+    return attacks;
+}
+
+static constexpr int KnightSteps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+static constexpr int KingSteps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+/**
+ * @brief Builds the table of squares reached by single steps from every square.
+ */
+static constexpr array<Bitboard, 64> makeStepAttacks(const int steps[8][2]) {
+    array<Bitboard, 64> table = {};
+    for (int square = 0; square < 64; ++square) {
+        for (int i = 0; i < 8; ++i) {
+            int s = offsetSquare(square, steps[i][0], steps[i][1]);
+            if (s != NO_SQUARE) table[square] |= squareBB(s);
+        }
+    }
+    return table;
+}
+
+static constexpr array<array<Bitboard, 64>, COLOR_NB> makePawnAttacks() {
+    array<array<Bitboard, 64>, COLOR_NB> table = {};
+    for (int square = 0; square < 64; ++square) {
+        for (int fileStep = -1; fileStep <= 1; fileStep += 2) {
+            int s = offsetSquare(square, fileStep, 1);
+            if (s != NO_SQUARE) table[WHITE][square] |= squareBB(s);
+            s = offsetSquare(square, fileStep, -1);
+            if (s != NO_SQUARE) table[BLACK][square] |= squareBB(s);
+        }
+    }
+    return table;
+}
+
+/**
+ * @brief Builds the between or line table for every pair of squares sharing a rank, file or diagonal.
+ * @param line True for the full line through both squares, false for the squares strictly between them.
+ */
+static constexpr array<array<Bitboard, 64>, 64> makeGeometry(bool line) {
+    array<array<Bitboard, 64>, 64> table = {};
+    for (int s1 = 0; s1 < 64; ++s1) {
+        for (int i = 0; i < 8; ++i) {
+            int fileStep = KingSteps[i][0];
+            int rankStep = KingSteps[i][1];
+            Bitboard full = rayAttacks(s1, 0, fileStep, rankStep) | rayAttacks(s1, 0, -fileStep, -rankStep) | squareBB(s1);
+            Bitboard between = 0;
+            for (int s2 = offsetSquare(s1, fileStep, rankStep); s2 != NO_SQUARE; s2 = offsetSquare(s2, fileStep, rankStep)) {
+                table[s1][s2] = line ? full : between;
+                between |= squareBB(s2);
+            }
+        }
+    }
+    return table;
+}
+
+static constexpr array<array<char, 3>, 64> makeSquareNames() {
+    array<array<char, 3>, 64> names = {};
+    for (int square = 0; square < 64; ++square) {
+        names[square] = {char('a' + fileOf(square)), char('1' + rankOf(square)), '\0'};
+    }
+    return names;
+}
+
+constexpr array<Bitboard, 64> KnightAttacks = makeStepAttacks(KnightSteps);
+constexpr array<Bitboard, 64> KingAttacks = makeStepAttacks(KingSteps);
+constexpr array<array<Bitboard, 64>, COLOR_NB> PawnAttacks = makePawnAttacks();
+constexpr array<array<Bitboard, 64>, 64> BetweenBB = makeGeometry(false);
+constexpr array<array<Bitboard, 64>, 64> LineBB = makeGeometry(true);
+
+constexpr array<array<char, 3>, 64> SquareNames = makeSquareNames();
+
+// Self-test of the compile time tables
+static_assert(KnightAttacks[0] == (squareBB(10) | squareBB(17)), "knight on a1 attacks b3 and c2");
+static_assert(popCount(KnightAttacks[makeSquare(3, 3)]) == 8, "knight on d4 attacks eight squares");
+static_assert(popCount(KingAttacks[makeSquare(4, 0)]) == 5 && popCount(KingAttacks[63]) == 3, "king attack counts");
+static_assert(PawnAttacks[WHITE][makeSquare(4, 1)] == (squareBB(makeSquare(3, 2)) | squareBB(makeSquare(5, 2))), "white pawn on e2");
+static_assert(PawnAttacks[BLACK][makeSquare(0, 6)] == squareBB(makeSquare(1, 5)), "black pawn on a7");
+static_assert(popCount(BetweenBB[0][63]) == 6 && BetweenBB[0][1] == 0, "between a1 and h8, a1 and b1");
+static_assert(BetweenBB[makeSquare(0, 0)][makeSquare(1, 2)] == 0 && LineBB[0][17] == 0, "a1 and b3 are not aligned");
+static_assert(LineBB[0][9] == LineBB[63][54] && popCount(LineBB[0][9]) == 8, "line through a1 and b2 is the long diagonal");
+static_assert(LineBB[makeSquare(4, 0)][makeSquare(4, 7)] == (FILE_A_BB << 4), "line through e1 and e8 is the e-file");
+static_assert(SquareNames[0][0] == 'a' && SquareNames[0][1] == '1' && SquareNames[63][0] == 'h' && SquareNames[63][1] == '8', "square names");
+
+/**
+ * @brief Walks each direction from a square until the edge of the board or the first occupied square.
+ */
+static Bitboard slidingAttacks(int square, Bitboard occupied, const int directions[4][2]) {
+    Bitboard attacks = 0;
+    for (int i = 0; i < 4; ++i) {
+        attacks |= rayAttacks(square, occupied, directions[i][0], directions[i][1]);
+    }
+    return attacks;
+}
+
+static const int RookDirections[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static const int BishopDirections[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+#if defined(PEXT_SUPPORTED) && !defined(__BMI2__)
+__attribute__((target("bmi2"))) uint64_t pextRuntime(uint64_t value, uint64_t mask) {
+    return _pext_u64(value, mask);
+}
+#endif
+
+/**
+ * @brief Checks whether the CPU running the game supports BMI2.
+ */
+static bool cpuHasBmi2() {
+#if defined(__BMI2__)
+    return true;
+#elif defined(PEXT_SUPPORTED)
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+bool usingPext() {
+    return pextEnabled;
+}
+
+/**
+ * @brief Fills the lookup data and attack tables for one sliding piece.
+ */
+static void initMagics(Magic magics[64], Bitboard* table, const Bitboard magicNumbers[64], const int directions[4][2]) {
+    // Empty board rays from every square, so filling an entry takes a few bit operations instead of a walk
+    Bitboard rays[4][64];
+    for (int d = 0; d < 4; ++d) {
+        for (int square = 0; square < 64; ++square) {
+            rays[d][square] = rayAttacks(square, 0, directions[d][0], directions[d][1]);
+        }
+    }
+
+    Bitboard* next = table;
+    for (int square = 0; square < 64; ++square) {
+        // Board edges never block a slider, so they are left out of the relevant occupancy
+        Bitboard edges = ((RANK_1_BB | RANK_8_BB) & ~(RANK_1_BB << (8 * rankOf(square))))
+                       | ((FILE_A_BB | FILE_H_BB) & ~(FILE_A_BB << fileOf(square)));
+
+        Magic& m = magics[square];
+        m.mask = slidingAttacks(square, 0, directions) & ~edges;
+        m.magic = magicNumbers[square];
+        m.shift = 64 - popCount(m.mask);
+        m.pext = pextEnabled;
+        m.attacks = next;
+
+        // Enumerate every subset of the mask with the Carry-Rippler trick
+        Bitboard occupied = 0;
+        do {
+            Bitboard attacks = 0;
+            for (int d = 0; d < 4; ++d) {
+                Bitboard ray = rays[d][square];
+                Bitboard blockers = ray & occupied;
+                if (blockers) {
+                    // The nearest blocker is the lowest bit on rays towards h8 and the highest on rays towards a1
+                    bool increasing = directions[d][0] + 8 * directions[d][1] > 0;
+                    ray ^= rays[d][increasing ? lsb(blockers) : msb(blockers)];
+                }
+                attacks |= ray;
+            }
+            m.attacks[m.index(occupied)] = attacks;
+            occupied = (occupied - m.mask) & m.mask;
+        } while (occupied);
+        next += 1ULL << popCount(m.mask);
+    }
+}
+
+void initBitboards() {
+    pextEnabled = cpuHasBmi2();
+    initMagics(RookMagics, RookTable, RookMagicNumbers, RookDirections);
+    initMagics(BishopMagics, BishopTable, BishopMagicNumbers, BishopDirections);
+}
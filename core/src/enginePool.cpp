@@ -0,0 +1,417 @@
+#include "enginePool.h"
+#include <iostream>
+#include <algorithm>
+#include "movegen.h"
+
+using namespace std;
+
+/**
+ * @brief Returns the milliseconds between two times.
+ */
+static double elapsedMs(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to) {
+    return chrono::duration<double, milli>(to - from).count();
+}
+
+void EngineJob::cancel() {
+    if (!state) {
+        return;
+    }
+    state->cancelled = true;
+    if (EnginePool* pool = state->queuedIn) {
+        pool->dropJob(state);
+    }
+}
+
+EnginePool::EnginePool() : stopping(false) {}
+
+EnginePool::~EnginePool() {
+    stop();
+}
+
+bool EnginePool::start(const EngineOptions& options, int count) {
+    stop();
+    {
+        lock_guard<mutex> lock(queueMutex);
+        this->options = options;
+    }
+
+    // Engines start up and allocate their hash tables in parallel
+    vector<unique_ptr<Engine>> started(max(count, 0));
+    vector<char> ready(started.size(), 0);
+    vector<thread> warmers;
+    for (size_t i = 0; i < started.size(); ++i) {
+        started[i] = make_unique<Engine>();
+        warmers.emplace_back([this, &started, &ready, i]() { ready[i] = warmUp(*started[i]); });
+    }
+    for (thread& t : warmers) {
+        t.join();
+    }
+
+    vector<unique_ptr<Engine>> running;
+    for (size_t i = 0; i < started.size(); ++i) {
+        if (ready[i]) {
+            running.push_back(move(started[i]));
+        }
+    }
+    bool all = running.size() == started.size();
+    if (!all) {
+        cerr << "Only " << running.size() << " of " << count << " engines started." << endl;
+    }
+
+    // The workers wait for the lock, so they only look at the queue once the engines are in place
+    lock_guard<mutex> lock(queueMutex);
+    engines = move(running);
+    stopping = false;
+    for (size_t i = 0; i < engines.size(); ++i) {
+        engines[i]->worker = thread(&EnginePool::workerLoop, this, ref(*engines[i]), int(i));
+    }
+    return all;
+}
+
+void EnginePool::stop() {
+    // The engines are taken out under the lock, so submit sees an empty pool from here on
+    vector<unique_ptr<Engine>> stopped;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+        stopped.swap(engines);
+    }
+    jobReady.notify_all();
+    for (auto& engine : stopped) {
+        if (engine->worker.joinable()) {
+            engine->worker.join();
+        }
+        if (engine->process.running()) {
+            engine->process.send("quit");
+        }
+        engine->process.stop();
+    }
+
+    // Jobs nobody will search are answered so their waiters wake up
+    lock_guard<mutex> lock(queueMutex);
+    for (auto& entry : queues) {
+        for (auto& job : entry.second) {
+            job->queuedIn = nullptr;
+            job->result.set_value(EngineResult());
+            stats.cancelled++;
+        }
+    }
+    queues.clear();
+    turns.clear();
+}
+
+bool EnginePool::waitReady(Engine& engine) {
+    string line;
+    engine.process.send("isready");
+    return engine.process.waitFor("readyok", line, POOL_HANDSHAKE_TIMEOUT_MS);
+}
+
+bool EnginePool::warmUp(Engine& engine) {
+    if (!engine.process.start(options.path, options.args)) {
+        return false;
+    }
+    string line;
+    engine.process.send("uci");
+    if (!engine.process.waitFor("uciok", line, POOL_HANDSHAKE_TIMEOUT_MS)) {
+        cerr << "Engine did not answer uci: " << options.path << endl;
+        engine.process.stop();
+        return false;
+    }
+    engine.process.send("setoption name Threads value " + to_string(options.threads));
+    engine.process.send("setoption name Hash value " + to_string(options.hashMb));
+
+    // The first readyok comes once the hash table is allocated, so the first job does not pay for it
+    if (!waitReady(engine)) {
+        cerr << "Engine did not answer isready: " << options.path << endl;
+        engine.process.stop();
+        return false;
+    }
+    return true;
+}
+
+EngineJob EnginePool::submit(int client, const Position& start, const vector<Move>& moves, SearchLimits limits,
+                             const EngineJobOptions& jobOptions) {
+    auto job = make_shared<EngineJobState>();
+    job->client = client;
+    job->start = start;
+    job->moves = moves;
+    job->position = start;
+    UndoInfo undo;
+    for (Move move : moves) {
+        job->position.makeMove(move, undo);
+    }
+    job->limits = limits;
+    job->options = jobOptions;
+    job->submitted = chrono::steady_clock::now();
+    EngineJob handle(job);
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (limits.depth <= 0 && limits.moveTimeMs <= 0) {
+            job->limits.depth = options.depth;
+        }
+        if (engines.empty() || stopping) {
+            job->result.set_value(EngineResult());
+            stats.cancelled++;
+            return handle;
+        }
+        deque<shared_ptr<EngineJobState>>& queue = queues[client];
+        if (queue.empty()) {
+            turns.push_back(client);
+        }
+        queue.push_back(job);
+        job->queuedIn = this;
+    }
+    // Every worker looks, since the job may be kept for the engine pondering on its client
+    jobReady.notify_all();
+    return handle;
+}
+
+void EnginePool::dropJob(const shared_ptr<EngineJobState>& job) {
+    lock_guard<mutex> lock(queueMutex);
+    // An engine may have taken the job since cancel looked, then the search is stopped instead
+    if (job->queuedIn != this) {
+        return;
+    }
+    auto queue = queues.find(job->client);
+    if (queue == queues.end()) {
+        return;
+    }
+    auto position = find(queue->second.begin(), queue->second.end(), job);
+    if (position == queue->second.end()) {
+        return;
+    }
+    queue->second.erase(position);
+    if (queue->second.empty()) {
+        queues.erase(queue);
+        turns.erase(find(turns.begin(), turns.end(), job->client));
+    }
+    job->queuedIn = nullptr;
+    job->result.set_value(EngineResult());
+    stats.cancelled++;
+}
+
+bool EnginePool::mayTake(const Engine& engine, int client) const {
+    if (engine.pondering && engine.ponderClient == client) {
+        return true;
+    }
+    // A client's next job is kept for the engine pondering on its reply
+    for (const auto& other : engines) {
+        if (other.get() != &engine && other->pondering && other->ponderClient == client) {
+            return false;
+        }
+    }
+    // A pondering engine only gives its ponder search up when no other engine is free
+    return !engine.pondering || idle == 0;
+}
+
+shared_ptr<EngineJobState> EnginePool::takeJob(Engine& engine) {
+    unique_lock<mutex> lock(queueMutex);
+    while (!stopping) {
+        auto turn = find_if(turns.begin(), turns.end(), [&](int client) {
+            return engine.pondering && client == engine.ponderClient;
+        });
+        if (turn == turns.end()) {
+            turn = find_if(turns.begin(), turns.end(), [&](int client) { return mayTake(engine, client); });
+        }
+        if (turn != turns.end()) {
+            // The client served goes to the back of the line if it has more jobs waiting
+            int client = *turn;
+            turns.erase(turn);
+            deque<shared_ptr<EngineJobState>>& queue = queues[client];
+            shared_ptr<EngineJobState> job = queue.front();
+            queue.pop_front();
+            if (queue.empty()) {
+                queues.erase(client);
+            } else {
+                turns.push_back(client);
+            }
+            job->queuedIn = nullptr;
+            return job;
+        }
+
+        if (!engine.pondering) {
+            idle++;
+            jobReady.wait(lock);
+            idle--;
+            continue;
+        }
+        lock.unlock();
+        bool pondering = drainPonderOutput(engine);
+        lock.lock();
+        if (!pondering) {
+            // Jobs kept for this engine may go to any engine now
+            engine.pondering = false;
+            jobReady.notify_all();
+            continue;
+        }
+        jobReady.wait_for(lock, chrono::milliseconds(POOL_POLL_MS));
+    }
+    return nullptr;
+}
+
+void EnginePool::workerLoop(Engine& engine, int index) {
+    while (shared_ptr<EngineJobState> job = takeJob(engine)) {
+        EngineResult result;
+        auto taken = chrono::steady_clock::now();
+        result.queueWaitMs = elapsedMs(job->submitted, taken);
+        result.engine = index;
+
+        // A job cancelled while an engine was taking it is not searched at all
+        string ponder;
+        string best = job->cancelled ? "" : search(engine, *job, ponder);
+        result.searchMs = elapsedMs(taken, chrono::steady_clock::now());
+
+        bool cancelled = job->cancelled || stopping;
+        if (!cancelled && !best.empty()) {
+            result.move = parseUciMove(job->position, best);
+            if (!result.move.isNone() && !job->position.isLegal(result.move.from(), result.move.to())) {
+                cerr << "Engine played an illegal move: " << best << endl;
+                result.move = MOVE_NONE;
+            }
+            if (!result.move.isNone() && !ponder.empty()) {
+                Position next = job->position;
+                UndoInfo undo;
+                next.makeMove(result.move, undo);
+                result.ponder = parseUciMove(next, ponder);
+                if (!result.ponder.isNone() && !next.isLegal(result.ponder.from(), result.ponder.to())) {
+                    result.ponder = MOVE_NONE;
+                }
+            }
+        }
+
+        {
+            lock_guard<mutex> lock(queueMutex);
+            if (cancelled) {
+                stats.cancelled++;
+            } else {
+                stats.searched++;
+                stats.totalQueueWaitMs += result.queueWaitMs;
+                stats.maxQueueWaitMs = max(stats.maxQueueWaitMs, result.queueWaitMs);
+                stats.totalSearchMs += result.searchMs;
+            }
+        }
+        job->result.set_value(result);
+
+        // The client thinks about its reply while the engine ponders on the one it expects
+        if (job->options.ponder && !result.ponder.isNone() && !stopping) {
+            startPondering(engine, *job, best, ponder);
+        }
+    }
+}
+
+string EnginePool::search(Engine& engine, EngineJobState& job, string& ponder) {
+    if (!engine.process.running()) {
+        // An engine that died is restarted once per job rather than taken out of the pool
+        cerr << "Engine exited, restarting it." << endl;
+        {
+            lock_guard<mutex> lock(queueMutex);
+            engine.pondering = false;
+        }
+        engine.lastClient = -1;
+        engine.uciOptions.clear();
+        if (!warmUp(engine)) {
+            return "";
+        }
+    }
+
+    string go = uciGoCommand(job.limits);
+    bool optionsChanged = false;
+    for (const auto& option : job.options.uciOptions) {
+        auto sent = engine.uciOptions.find(option.first);
+        optionsChanged = optionsChanged || sent == engine.uciOptions.end() || sent->second != option.second;
+    }
+    bool ponderHit = false;
+    if (engine.pondering) {
+        ponderHit = job.client == engine.ponderClient && !job.options.newGame && !optionsChanged
+                    && job.position.key() == engine.ponderKey && go == engine.ponderGo;
+        if (ponderHit) {
+            // The client made the expected reply, so the ponder search carries on as the real one
+            engine.process.send("ponderhit");
+        } else {
+            stopPondering(engine);
+        }
+        lock_guard<mutex> lock(queueMutex);
+        engine.pondering = false;
+        // A ponder search ended by a new game counts as neither a hit nor a miss
+        if (ponderHit) {
+            stats.ponderHits++;
+        } else if (!job.options.newGame) {
+            stats.ponderMisses++;
+        }
+    }
+
+    if (!ponderHit) {
+        for (const auto& option : job.options.uciOptions) {
+            auto sent = engine.uciOptions.find(option.first);
+            if (sent == engine.uciOptions.end() || sent->second != option.second) {
+                engine.process.send("setoption name " + option.first + " value " + option.second);
+                engine.uciOptions[option.first] = option.second;
+            }
+        }
+
+        // The hash table only carries over between jobs of the same game, which is what a client is
+        if (engine.lastClient != job.client || job.options.newGame) {
+            engine.process.send("ucinewgame");
+            waitReady(engine);
+            engine.lastClient = job.client;
+        }
+        engine.process.send(uciPositionCommand(job.start, job.moves));
+        engine.process.send(go);
+    }
+
+    // An engine that hangs is stopped here and restarted by the next job it takes
+    string line, best;
+    SearchOutcome outcome = engine.process.waitBestMove(line, [&]() { return job.cancelled || stopping; },
+                                                        POOL_SEARCH_TIMEOUT_MS, POOL_HANDSHAKE_TIMEOUT_MS, POOL_POLL_MS);
+    if (outcome != SEARCH_FINISHED || !parseBestMove(line, best, ponder)) {
+        return "";
+    }
+    return best;
+}
+
+void EnginePool::startPondering(Engine& engine, const EngineJobState& job, const string& best, const string& reply) {
+    Position expected = job.position;
+    UndoInfo undo;
+    expected.makeMove(parseUciMove(expected, best), undo);
+    expected.makeMove(parseUciMove(expected, reply), undo);
+
+    engine.process.send(uciPositionCommand(job.start, job.moves) + (job.moves.empty() ? " moves " : " ") + best + " " + reply);
+    engine.process.send(uciGoCommand(job.limits, true));
+    engine.ponderKey = expected.key();
+    engine.ponderGo = uciGoCommand(job.limits);
+    lock_guard<mutex> lock(queueMutex);
+    engine.pondering = true;
+    engine.ponderClient = job.client;
+}
+
+void EnginePool::stopPondering(Engine& engine) {
+    engine.process.send("stop");
+    string line;
+    if (!engine.process.waitFor("bestmove", line, POOL_HANDSHAKE_TIMEOUT_MS)) {
+        cerr << "Engine did not answer stop while pondering." << endl;
+    }
+    lock_guard<mutex> lock(queueMutex);
+    engine.pondering = false;
+}
+
+bool EnginePool::drainPonderOutput(Engine& engine) {
+    string line;
+    while (engine.process.readLine(line, 0)) {
+        // An engine that ends a ponder search on its own is no longer pondering
+        if (line.compare(0, 8, "bestmove") == 0) {
+            return false;
+        }
+    }
+    return engine.process.running();
+}
+
+int EnginePool::size() const {
+    lock_guard<mutex> lock(queueMutex);
+    return int(engines.size());
+}
+
+EnginePoolStats EnginePool::getStats() const {
+    lock_guard<mutex> lock(queueMutex);
+    return stats;
+}
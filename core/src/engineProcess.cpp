@@ -0,0 +1,316 @@
+#include "engineProcess.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+extern char** environ;
+
+static_assert((ENGINE_BUFFER_SIZE & (ENGINE_BUFFER_SIZE - 1)) == 0, "ENGINE_BUFFER_SIZE must be a power of two");
+
+// Pipes are created, marked close-on-exec and handed to a child under this lock, so an engine started
+// from another thread at the same time never inherits them
+static mutex spawnMutex;
+
+/**
+ * @brief Creates a pipe whose ends are closed on exec.
+ */
+static bool closeOnExecPipe(int fds[2]) {
+    if (pipe(fds) < 0) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+/**
+ * @brief Returns the milliseconds left until a deadline, at least 0.
+ */
+static int remainingMs(chrono::steady_clock::time_point deadline) {
+    auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+    return left > 0 ? int(left) : 0;
+}
+
+EngineProcess::EngineProcess() : pid(-1), toChild(-1), fromChild(-1), head(0), tail(0), scanned(0), outputClosed(false) {}
+
+EngineProcess::~EngineProcess() {
+    stop();
+}
+
+bool EngineProcess::start(const string& path, const vector<string>& args) {
+    stop();
+
+    lock_guard<mutex> lock(spawnMutex);
+    int input[2], output[2];
+    if (!closeOnExecPipe(input)) {
+        cerr << "Failed to create engine input pipe: " << strerror(errno) << endl;
+        return false;
+    }
+    if (!closeOnExecPipe(output)) {
+        cerr << "Failed to create engine output pipe: " << strerror(errno) << endl;
+        close(input[0]);
+        close(input[1]);
+        return false;
+    }
+
+    // dup2 clears close-on-exec on the child's copies, every other descriptor of ours stays closed in the child
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, input[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, output[1], STDOUT_FILENO);
+
+    vector<char*> argv;
+    argv.push_back(const_cast<char*>(path.c_str()));
+    for (const string& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    int result = posix_spawn(&pid, path.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(input[0]);
+    close(output[1]);
+    if (result != 0) {
+        cerr << "Failed to start engine " << path << ": " << strerror(result) << endl;
+        close(input[1]);
+        close(output[0]);
+        pid = -1;
+        return false;
+    }
+
+    toChild = input[1];
+    fromChild = output[0];
+    fcntl(fromChild, F_SETFL, fcntl(fromChild, F_GETFL) | O_NONBLOCK);
+    head = tail = scanned = 0;
+    outputClosed = false;
+    return true;
+}
+
+void EngineProcess::closePipes() {
+    if (toChild >= 0) {
+        close(toChild);
+    }
+    if (fromChild >= 0) {
+        close(fromChild);
+    }
+    toChild = fromChild = -1;
+}
+
+void EngineProcess::stop(int graceMs) {
+    if (pid < 0) {
+        closePipes();
+        return;
+    }
+
+    // End of input makes UCI engines quit, signals are only needed for hung ones
+    if (toChild >= 0) {
+        close(toChild);
+        toChild = -1;
+    }
+    const int signals[] = {0, SIGTERM};
+    for (int sig : signals) {
+        if (sig) {
+            kill(pid, sig);
+        }
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(graceMs);
+        do {
+            if (waitpid(pid, nullptr, WNOHANG) != 0) {
+                pid = -1;
+                closePipes();
+                return;
+            }
+            this_thread::sleep_for(chrono::milliseconds(5));
+        } while (remainingMs(deadline) > 0);
+    }
+
+    // SIGKILL cannot be ignored, so a blocking wait returns promptly
+    kill(pid, SIGKILL);
+    while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {}
+    pid = -1;
+    closePipes();
+}
+
+bool EngineProcess::running() {
+    if (pid < 0) {
+        return false;
+    }
+    if (waitpid(pid, nullptr, WNOHANG) != 0) {
+        pid = -1;
+        closePipes();
+        return false;
+    }
+    return true;
+}
+
+bool EngineProcess::send(const string& line) {
+    if (toChild < 0) {
+        return false;
+    }
+    string data = line + "\n";
+
+    // A write to an engine that died raises SIGPIPE on this thread. It is blocked for the write and taken
+    // off again if the write raised it, so the program's own SIGPIPE handling is left alone
+    sigset_t pipeSignal, oldMask, pending;
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+    sigpending(&pending);
+    bool alreadyPending = sigismember(&pending, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSignal, &oldMask);
+
+    size_t written = 0;
+    bool ok = true;
+    while (written < data.size()) {
+        ssize_t n = write(toChild, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            int error = errno;
+            if (error == EPIPE && !alreadyPending) {
+                sigpending(&pending);
+                int taken;
+                if (sigismember(&pending, SIGPIPE)) {
+                    sigwait(&pipeSignal, &taken);
+                }
+            }
+            cerr << "Failed to write to engine: " << strerror(error) << endl;
+            ok = false;
+            break;
+        }
+        written += n;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+    return ok;
+}
+
+bool EngineProcess::fill() {
+    while (head - tail < ENGINE_BUFFER_SIZE) {
+        // Read up to the end of the free space or the end of the array, whichever comes first
+        size_t start = head & (ENGINE_BUFFER_SIZE - 1);
+        size_t space = min(ENGINE_BUFFER_SIZE - (head - tail), ENGINE_BUFFER_SIZE - start);
+        ssize_t n = read(fromChild, buffer + start, space);
+        if (n > 0) {
+            head += n;
+        } else if (n == 0) {
+            outputClosed = true;
+            return false;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;
+        } else if (errno != EINTR) {
+            outputClosed = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EngineProcess::takeLine(string& line) {
+    for (; tail + scanned < head; ++scanned) {
+        if (buffer[(tail + scanned) & (ENGINE_BUFFER_SIZE - 1)] == '\n') {
+            break;
+        }
+    }
+
+    // A line longer than the whole buffer is handed out in pieces rather than stalling the reader
+    bool complete = tail + scanned < head;
+    if (!complete && scanned < ENGINE_BUFFER_SIZE) {
+        return false;
+    }
+
+    line.clear();
+    for (size_t i = 0; i < scanned; ++i) {
+        line += buffer[(tail + i) & (ENGINE_BUFFER_SIZE - 1)];
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    tail += scanned + (complete ? 1 : 0);
+    scanned = 0;
+    return true;
+}
+
+bool EngineProcess::readLine(string& line, int timeoutMs) {
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    while (true) {
+        if (takeLine(line)) {
+            return true;
+        }
+        if (fromChild < 0) {
+            return false;
+        }
+
+        bool open = fill();
+        if (takeLine(line)) {
+            return true;
+        }
+        if (!open) {
+            return false;
+        }
+
+        int wait = remainingMs(deadline);
+        if (wait == 0) {
+            return false;
+        }
+        pollfd fd = {fromChild, POLLIN, 0};
+        if (poll(&fd, 1, wait) < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+bool EngineProcess::waitFor(const string& prefix, string& line, int timeoutMs) {
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    while (readLine(line, remainingMs(deadline))) {
+        if (line.compare(0, prefix.size(), prefix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SearchOutcome EngineProcess::waitBestMove(string& line, const function<bool()>& shouldStop, int timeoutMs, int stopTimeoutMs, int pollMs) {
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    bool stopped = false;
+    while (true) {
+        if (readLine(line, pollMs)) {
+            if (line.compare(0, 8, "bestmove") == 0) {
+                return SEARCH_FINISHED;
+            }
+            continue;
+        }
+        if (!running()) {
+            return SEARCH_EXITED;
+        }
+        // Output ends a moment before the child can be reaped, so the wait goes on at the poll rate
+        if (outputClosed) {
+            this_thread::sleep_for(chrono::milliseconds(pollMs));
+        }
+
+        auto now = chrono::steady_clock::now();
+        if (!stopped && (now >= deadline || shouldStop())) {
+            if (now >= deadline) {
+                cerr << "Engine search timed out, stopping it." << endl;
+            }
+            send("stop");
+            stopped = true;
+            deadline = now + chrono::milliseconds(stopTimeoutMs);
+        } else if (stopped && now >= deadline) {
+            cerr << "Engine did not answer stop." << endl;
+            stop();
+            return SEARCH_HUNG;
+        }
+    }
+}
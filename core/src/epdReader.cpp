@@ -0,0 +1,340 @@
+#include "epdReader.h"
+#include <iostream>
+#include <thread>
+#include <array>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define EPD_SIMD_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define EPD_SIMD_NEON
+#endif
+
+using namespace std;
+
+enum CharClass : uint8_t {
+    BOARD_CHAR = 1, // Digit 1 to 8, slash or piece letter
+    SPACE_CHAR = 2,
+    NEWLINE_CHAR = 4
+};
+
+static constexpr array<uint8_t, 256> makeCharClasses() {
+    array<uint8_t, 256> classes{};
+    const char board[] = "12345678/pnbrqkPNBRQK";
+    for (int i = 0; board[i]; ++i) {
+        classes[uint8_t(board[i])] = BOARD_CHAR;
+    }
+    classes[' '] = SPACE_CHAR;
+    classes['\n'] = NEWLINE_CHAR;
+    return classes;
+}
+
+// Character classes for the scalar path and the tails of SIMD scans
+static constexpr array<uint8_t, 256> CharClasses = makeCharClasses();
+
+/**
+ * @struct LineScan
+ * @brief Where a line and its board field end, and whether the board field holds only board characters.
+ */
+struct LineScan {
+    const char* lineEnd; // The newline ending the line, or the end of the file
+    const char* boardEnd; // The first space or the line end
+    bool boardValid; // Whether every character before boardEnd is a board character
+};
+
+/**
+ * @brief Continues a line scan byte by byte.
+ */
+static LineScan scanScalar(const char* p, const char* end, LineScan scan) {
+    for (; p < end; ++p) {
+        uint8_t cls = CharClasses[uint8_t(*p)];
+        if (!scan.boardEnd) {
+            if (cls & (SPACE_CHAR | NEWLINE_CHAR)) {
+                scan.boardEnd = p;
+            } else if (!(cls & BOARD_CHAR)) {
+                scan.boardValid = false;
+            }
+        }
+        if (cls & NEWLINE_CHAR) {
+            scan.lineEnd = p;
+            return scan;
+        }
+    }
+    if (!scan.boardEnd) {
+        scan.boardEnd = end;
+    }
+    scan.lineEnd = end;
+    return scan;
+}
+
+#if defined(EPD_SIMD_SSE2) || defined(EPD_SIMD_NEON)
+
+/**
+ * @struct BlockMasks
+ * @brief Classes of the 16 bytes of a block as bit masks, BlockBits bits per byte.
+ */
+struct BlockMasks {
+    uint64_t newline;
+    uint64_t space;
+    uint64_t board;
+};
+
+#if defined(EPD_SIMD_SSE2)
+
+const int BlockBits = 1;
+const uint64_t BlockAll = 0xFFFF;
+
+static inline BlockMasks classifyBlock(const char* p) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0')), _mm_cmplt_epi8(v, _mm_set1_epi8('9')));
+    // Setting bit 5 folds upper case letters onto lower case ones and leaves digits and slashes alone
+    __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i board = _mm_or_si128(digit, _mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+    board = _mm_or_si128(board, _mm_cmpeq_epi8(folded, _mm_set1_epi8('p')));
+    board = _mm_or_si128(board, _mm_cmpeq_epi8(folded, _mm_set1_epi8('n')));
+    board = _mm_or_si128(board, _mm_cmpeq_epi8(folded, _mm_set1_epi8('b')));
+    board = _mm_or_si128(board, _mm_cmpeq_epi8(folded, _mm_set1_epi8('r')));
+    board = _mm_or_si128(board, _mm_cmpeq_epi8(folded, _mm_set1_epi8('q')));
+    board = _mm_or_si128(board, _mm_cmpeq_epi8(folded, _mm_set1_epi8('k')));
+    return {
+        uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')))),
+        uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')))),
+        uint64_t(_mm_movemask_epi8(board))
+    };
+}
+
+#else
+
+const int BlockBits = 4;
+const uint64_t BlockAll = ~0ULL;
+
+/**
+ * @brief Narrows a NEON comparison result to a 64-bit mask with four bits per byte.
+ */
+static inline uint64_t nibbleMask(uint8x16_t cmp) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+}
+
+static inline BlockMasks classifyBlock(const char* p) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    uint8x16_t digit = vandq_u8(vcgtq_u8(v, vdupq_n_u8('0')), vcltq_u8(v, vdupq_n_u8('9')));
+    // Setting bit 5 folds upper case letters onto lower case ones and leaves digits and slashes alone
+    uint8x16_t folded = vorrq_u8(v, vdupq_n_u8(0x20));
+    uint8x16_t board = vorrq_u8(digit, vceqq_u8(v, vdupq_n_u8('/')));
+    board = vorrq_u8(board, vceqq_u8(folded, vdupq_n_u8('p')));
+    board = vorrq_u8(board, vceqq_u8(folded, vdupq_n_u8('n')));
+    board = vorrq_u8(board, vceqq_u8(folded, vdupq_n_u8('b')));
+    board = vorrq_u8(board, vceqq_u8(folded, vdupq_n_u8('r')));
+    board = vorrq_u8(board, vceqq_u8(folded, vdupq_n_u8('q')));
+    board = vorrq_u8(board, vceqq_u8(folded, vdupq_n_u8('k')));
+    return {
+        nibbleMask(vceqq_u8(v, vdupq_n_u8('\n'))),
+        nibbleMask(vceqq_u8(v, vdupq_n_u8(' '))),
+        nibbleMask(board)
+    };
+}
+
+#endif
+
+/**
+ * @brief Scans a line 16 bytes at a time, finishing the last partial block byte by byte.
+ */
+static LineScan scanSimd(const char* p, const char* end) {
+    LineScan scan = {nullptr, nullptr, true};
+    for (; end - p >= 16; p += 16) {
+        BlockMasks masks = classifyBlock(p);
+        if (!scan.boardEnd) {
+            // Only the bytes before the first space or newline belong to the board field
+            uint64_t stop = masks.space | masks.newline;
+            uint64_t field = stop ? (1ULL << __builtin_ctzll(stop)) - 1 : BlockAll;
+            if (field & ~masks.board) {
+                scan.boardValid = false;
+            }
+            if (stop) {
+                scan.boardEnd = p + __builtin_ctzll(stop) / BlockBits;
+            }
+        }
+        if (masks.newline) {
+            scan.lineEnd = p + __builtin_ctzll(masks.newline) / BlockBits;
+            return scan;
+        }
+    }
+    return scanScalar(p, end, scan);
+}
+
+#endif
+
+/**
+ * @brief Scans one line for its end and its board field.
+ */
+static inline LineScan scanLine(const char* p, const char* end, bool simd) {
+#if defined(EPD_SIMD_SSE2) || defined(EPD_SIMD_NEON)
+    if (simd) {
+        return scanSimd(p, end);
+    }
+#endif
+    return scanScalar(p, end, {nullptr, nullptr, true});
+}
+
+bool EpdReader::simdAvailable() {
+#if defined(EPD_SIMD_SSE2) || defined(EPD_SIMD_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+EpdReader::EpdReader(size_t batchBytes)
+    : data(nullptr), length(0), batchBytes(max<size_t>(batchBytes, 1)), cursor(0), simd(simdAvailable()) {}
+
+EpdReader::~EpdReader() {
+    close();
+}
+
+bool EpdReader::open(const string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Failed to open EPD file: " << path << endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        cerr << "Failed to stat EPD file: " << path << endl;
+        ::close(fd);
+        return false;
+    }
+
+    length = info.st_size;
+    if (length > 0) {
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            cerr << "Failed to map EPD file: " << path << endl;
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        madvise(mapping, length, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapping);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    rewind();
+    return true;
+}
+
+void EpdReader::close() {
+    if (data) {
+        munmap(const_cast<char*>(data), length);
+    }
+    data = nullptr;
+    length = 0;
+    rewind();
+}
+
+size_t EpdReader::lineStart(size_t offset) const {
+    if (offset == 0 || offset >= length) {
+        return min(offset, length);
+    }
+    const void* newline = memchr(data + offset - 1, '\n', length - offset + 1);
+    return newline ? static_cast<const char*>(newline) - data + 1 : length;
+}
+
+bool EpdReader::nextBatch(EpdBatch& batch) {
+    batch.records.clear();
+    batch.invalid = 0;
+    batch.bytes = 0;
+
+    // A line belongs to the batch its first byte was claimed with
+    size_t begin, end;
+    do {
+        size_t claimed = cursor.fetch_add(batchBytes);
+        if (claimed >= length) {
+            return false;
+        }
+        begin = lineStart(claimed);
+        end = lineStart(min(claimed + batchBytes, length));
+    } while (begin >= end);
+
+    batch.bytes = end - begin;
+    const char* p = data + begin;
+    const char* stop = data + end;
+    while (p < stop) {
+        LineScan scan = scanLine(p, stop, simd);
+        const char* line = p;
+        p = scan.lineEnd + 1;
+
+        // Blank lines and comments are not counted as invalid
+        if (scan.lineEnd == line || *line == '#' || *line == '\r') {
+            continue;
+        }
+        if (!scan.boardValid || scan.boardEnd == line) {
+            batch.invalid++;
+            continue;
+        }
+
+        EpdRecord record;
+        const char* lineEnd = (scan.lineEnd[-1] == '\r') ? scan.lineEnd - 1 : scan.lineEnd;
+        if (!record.position.set(line, lineEnd - line)) {
+            batch.invalid++;
+            continue;
+        }
+
+        // Operations follow the board, side to move, castling and en passant fields
+        const char* ops = scan.boardEnd;
+        for (int field = 0; field < 3 && ops < lineEnd; ++field) {
+            while (ops < lineEnd && *ops == ' ') ++ops;
+            while (ops < lineEnd && *ops != ' ') ++ops;
+        }
+        while (ops < lineEnd && *ops == ' ') ++ops;
+        record.operations = ops;
+        record.operationsLength = lineEnd - ops;
+        record.offset = line - data;
+        batch.records.push_back(record);
+    }
+    return true;
+}
+
+void EpdReader::run(int threads, const function<void(const EpdBatch&)>& handler) {
+    auto worker = [&]() {
+        EpdBatch batch;
+        while (nextBatch(batch)) {
+            handler(batch);
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (thread& t : pool) {
+        t.join();
+    }
+}
+
+size_t EpdReader::scan(size_t& validBoards) const {
+    size_t lines = 0;
+    validBoards = 0;
+    const char* p = data;
+    const char* end = data + length;
+    while (p < end) {
+        LineScan line = scanLine(p, end, simd);
+        if (line.lineEnd > p) {
+            lines++;
+            if (line.boardValid && line.boardEnd > p) {
+                validBoards++;
+            }
+        }
+        p = line.lineEnd + 1;
+    }
+    return lines;
+}
@@ -0,0 +1,48 @@
+#include "fen.h"
+#include <iostream>
+#include <cctype>
+
+using namespace std;
+
+void printFEN(const string& fen) {
+    // Split the FEN string into parts
+    string boardPart = fen.substr(0, fen.find(' '));
+    
+    // Create an 8x8 board representation
+    char board[8][8];
+    
+    // Initialize the board with empty squares
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            board[r][c] = '.'; // Use '.' for empty squares
+        }
+    }
+
+    int row = 0, col = 0;
+
+    for (char c : boardPart) {
+        if (isdigit(c)) { // If the character is a digit
+            int emptySquares = c - '0'; // Convert char to int
+            for (int i = 0; i < emptySquares; ++i) {
+                if (col < 8) { // Ensure we do not overflow the board
+                    board[row][col++] = '.'; // Use '.' for empty squares
+                }
+            }
+        } else if (c == '/') { // Move to the next row
+            row++;
+            col = 0; // Reset column index
+        } else { // Place the piece on the board
+            if (col < 8) { // Ensure we do not overflow the board
+                board[row][col++] = c;
+            }
+        }
+    }
+
+    // Print the board
+    for (int r = 7; r >= 0; --r) {
+        for (int c = 0; c < 8; ++c) {
+            cout << board[r][c] << ' ';
+        }
+        cout << endl;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "gameStatus.h"
+#include "movegen.h"
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Checks if neither side has enough material left to deliver mate.
+ */
+static bool insufficientMaterial(const Position& pos) {
+    if (pos.pieces(PAWN) | pos.pieces(ROOK) | pos.pieces(QUEEN)) {
+        return false;
+    }
+
+    // King against king with at most one minor piece
+    Bitboard minors = pos.pieces(KNIGHT) | pos.pieces(BISHOP);
+    if (!moreThanOne(minors)) {
+        return true;
+    }
+
+    // Only bishops left, all on squares of the same color
+    const Bitboard darkSquares = 0xAA55AA55AA55AA55ULL;
+    return !pos.pieces(KNIGHT) && (!(minors & darkSquares) || !(minors & ~darkSquares));
+}
+
+bool isThreefoldRepetition(const Position& pos, const vector<Key>& history) {
+    /**
+     * Only positions with the same side to move since the last capture or pawn move can repeat,
+     * so step back two plies at a time within the halfmove clock
+     */
+    int current = (int)history.size() - 1;
+    int oldest = max(0, current - pos.halfmoveClock());
+    int count = 1;
+    for (int ply = current - 2; ply >= oldest; ply -= 2) {
+        if (history[ply] == pos.key() && ++count >= 3) {
+            return true;
+        }
+    }
+    return false;
+}
+
+GameStatus computeGameStatus(const Position& pos, const vector<Key>& history, const AttackMap* attacks) {
+    GameStatus status;
+    status.sideToMove = pos.sideToMove();
+    int king = pos.kingSquare(status.sideToMove);
+    if (attacks && king != NO_SQUARE) {
+        status.check = attacks->isAttacked(king, ~status.sideToMove);
+    } else {
+        status.check = pos.checkers() != 0;
+    }
+
+    if (!hasLegalMove(pos, attacks)) {
+        if (status.check) {
+            status.checkmate = true;
+        } else {
+            status.draw = DRAW_STALEMATE;
+        }
+    } else if (pos.halfmoveClock() >= 100) {
+        status.draw = DRAW_FIFTY_MOVES;
+    } else if (insufficientMaterial(pos)) {
+        status.draw = DRAW_INSUFFICIENT_MATERIAL;
+    } else if (isThreefoldRepetition(pos, history)) {
+        status.draw = DRAW_REPETITION;
+    }
+    return status;
+}
+
+string drawReasonToString(DrawReason reason) {
+    switch (reason) {
+        case DRAW_STALEMATE: return "stalemate";
+        case DRAW_FIFTY_MOVES: return "fifty-move rule";
+        case DRAW_INSUFFICIENT_MATERIAL: return "insufficient material";
+        case DRAW_REPETITION: return "threefold repetition";
+        default: return "none";
+    }
+}
@@ -0,0 +1,186 @@
+#include "movegen.h"
+
+using namespace std;
+
+Move makeMove(const Position& pos, int from, int to, PieceType promotion) {
+    if (pos.isCastling(from, to)) {
+        return Move(from, to, CASTLING_MOVE);
+    }
+    if (pos.isEnPassant(from, to)) {
+        return Move(from, to, EN_PASSANT_MOVE);
+    }
+    if ((pos.pieces(PAWN) & squareBB(from)) && (rankOf(to) == 7 || rankOf(to) == 0)) {
+        if (promotion < KNIGHT || promotion > QUEEN) {
+            promotion = QUEEN;
+        }
+        return Move(from, to, PROMOTION_MOVE, promotion);
+    }
+    return Move(from, to);
+}
+
+Move parseUciMove(const Position& pos, const string& text) {
+    // Engine replies may carry a trailing newline
+    size_t length = text.find_last_not_of(" \t\r\n") + 1;
+    if (length < 4 || length > 5) {
+        return MOVE_NONE;
+    }
+    int from = notationToSquare(text.substr(0, 2));
+    int to = notationToSquare(text.substr(2, 2));
+    if (from == NO_SQUARE || to == NO_SQUARE || from == to) {
+        return MOVE_NONE;
+    }
+
+    PieceType promotion = QUEEN;
+    if (length == 5) {
+        switch (text[4]) {
+            case 'n': promotion = KNIGHT; break;
+            case 'b': promotion = BISHOP; break;
+            case 'r': promotion = ROOK; break;
+            case 'q': promotion = QUEEN; break;
+            default: return MOVE_NONE;
+        }
+    }
+    return makeMove(pos, from, to, promotion);
+}
+
+/**
+ * @brief Adds a move for every target square in a bitboard.
+ */
+static void addMoves(MoveList& list, int from, Bitboard targets) {
+    while (targets) {
+        list.add(Move(from, popLsb(targets)));
+    }
+}
+
+/**
+ * @brief Adds the pawn moves reaching each target square, expanding them to all four promotions on the last rank.
+ * @tparam Step The square offset from source to destination.
+ */
+template <int Step>
+static void addPawnMoves(MoveList& list, Bitboard targets, Bitboard promotionRank) {
+    while (targets) {
+        int to = popLsb(targets);
+        int from = to - Step;
+        if (promotionRank & squareBB(to)) {
+            list.add(Move(from, to, PROMOTION_MOVE, QUEEN));
+            list.add(Move(from, to, PROMOTION_MOVE, ROOK));
+            list.add(Move(from, to, PROMOTION_MOVE, BISHOP));
+            list.add(Move(from, to, PROMOTION_MOVE, KNIGHT));
+        } else {
+            list.add(Move(from, to));
+        }
+    }
+}
+
+/**
+ * @brief Generates the pawn moves of one side, shifting all pawns at once.
+ */
+template <Color Us>
+static void generatePawnMoves(const Position& pos, MoveList& list) {
+    constexpr int Up = (Us == WHITE) ? 8 : -8;
+    constexpr int UpWest = (Us == WHITE) ? 7 : -9;
+    constexpr int UpEast = (Us == WHITE) ? 9 : -7;
+    constexpr Bitboard SinglePushRank = (Us == WHITE) ? RANK_1_BB << 16 : RANK_1_BB << 40; // Rank a pawn reaches with its first step
+    constexpr Bitboard PromotionRank = (Us == WHITE) ? RANK_8_BB : RANK_1_BB;
+
+    Bitboard pawns = pos.pieces(Us, PAWN);
+    Bitboard empty = ~pos.pieces();
+    Bitboard enemies = pos.pieces(~Us);
+
+    Bitboard singlePushes = shift<Up>(pawns) & empty;
+    Bitboard doublePushes = shift<Up>(singlePushes & SinglePushRank) & empty;
+    addPawnMoves<Up>(list, singlePushes, PromotionRank);
+    while (doublePushes) {
+        int to = popLsb(doublePushes);
+        list.add(Move(to - 2 * Up, to));
+    }
+    addPawnMoves<UpWest>(list, shift<UpWest>(pawns) & enemies, PromotionRank);
+    addPawnMoves<UpEast>(list, shift<UpEast>(pawns) & enemies, PromotionRank);
+
+    if (pos.epSquare() != NO_SQUARE) {
+        Bitboard capturers = PawnAttacks[~Us][pos.epSquare()] & pawns;
+        while (capturers) {
+            list.add(Move(popLsb(capturers), pos.epSquare(), EN_PASSANT_MOVE));
+        }
+    }
+}
+
+/**
+ * @brief Generates the pseudo-legal moves of one side, so side dependent constants are known at compile time.
+ */
+template <Color Us>
+static void generatePseudoLegalMoves(const Position& pos, MoveList& list, const AttackMap* attacks) {
+    constexpr int KingFrom = (Us == WHITE) ? 4 : 60;
+    Bitboard occupied = pos.pieces();
+    Bitboard targets = ~pos.pieces(Us);
+
+    generatePawnMoves<Us>(pos, list);
+
+    Bitboard knights = pos.pieces(Us, KNIGHT);
+    while (knights) {
+        int from = popLsb(knights);
+        addMoves(list, from, KnightAttacks[from] & targets);
+    }
+    Bitboard bishops = pos.pieces(Us, BISHOP) | pos.pieces(Us, QUEEN);
+    while (bishops) {
+        int from = popLsb(bishops);
+        addMoves(list, from, bishopAttacks(from, occupied) & targets);
+    }
+    Bitboard rooks = pos.pieces(Us, ROOK) | pos.pieces(Us, QUEEN);
+    while (rooks) {
+        int from = popLsb(rooks);
+        addMoves(list, from, rookAttacks(from, occupied) & targets);
+    }
+
+    int king = pos.kingSquare(Us);
+    if (king != NO_SQUARE) {
+        addMoves(list, king, KingAttacks[king] & targets);
+        if (king == KingFrom) {
+            if (attacks) {
+                Bitboard enemyAttacks = attacks->attacks(~Us);
+                if (pos.canCastle<Us>(true, enemyAttacks)) list.add(Move(KingFrom, KingFrom + 2, CASTLING_MOVE));
+                if (pos.canCastle<Us>(false, enemyAttacks)) list.add(Move(KingFrom, KingFrom - 2, CASTLING_MOVE));
+            } else {
+                if (pos.canCastle<Us>(true)) list.add(Move(KingFrom, KingFrom + 2, CASTLING_MOVE));
+                if (pos.canCastle<Us>(false)) list.add(Move(KingFrom, KingFrom - 2, CASTLING_MOVE));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Dispatches pseudo-legal move generation on the side to move.
+ */
+static void generatePseudoLegalMoves(const Position& pos, MoveList& list, const AttackMap* attacks) {
+    if (pos.sideToMove() == WHITE) {
+        generatePseudoLegalMoves<WHITE>(pos, list, attacks);
+    } else {
+        generatePseudoLegalMoves<BLACK>(pos, list, attacks);
+    }
+}
+
+void generatePseudoLegalMoves(const Position& pos, MoveList& list) {
+    generatePseudoLegalMoves(pos, list, nullptr);
+}
+
+void generateLegalMoves(const Position& pos, MoveList& list, const AttackMap* attacks) {
+    MoveList pseudoLegal;
+    generatePseudoLegalMoves(pos, pseudoLegal, attacks);
+
+    // Keep only the moves that do not leave our king attacked, deciding each with the position's masks
+    Bitboard pinned = pos.pinned();
+    int king = pos.kingSquare(pos.sideToMove());
+    bool safe = attacks && king != NO_SQUARE && !attacks->isAttacked(king, ~pos.sideToMove());
+    Bitboard checkers = safe ? 0 : pos.checkers();
+    for (const Move& move : pseudoLegal) {
+        if (pos.keepsKingSafe(move.from(), move.to(), pinned, checkers)) {
+            list.add(move);
+        }
+    }
+}
+
+bool hasLegalMove(const Position& pos, const AttackMap* attacks) {
+    MoveList list;
+    generateLegalMoves(pos, list, attacks);
+    return !list.empty();
+}
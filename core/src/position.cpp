@@ -0,0 +1,693 @@
+#include "position.h"
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+
+static const char PieceChars[] = "pnbrqk";
+
+/**
+ * @brief Builds the FEN piece letter table: (color << 3) | (type + 1) for piece letters, 0 for other characters.
+ */
+static constexpr array<uint8_t, 128> makePieceCodes() {
+    array<uint8_t, 128> codes{};
+    const char letters[] = "pnbrqk";
+    for (int pt = PAWN; pt < PIECE_TYPE_NB; ++pt) {
+        codes[letters[pt]] = (BLACK << 3) | (pt + 1);
+        codes[letters[pt] - 'a' + 'A'] = (WHITE << 3) | (pt + 1);
+    }
+    return codes;
+}
+
+// Parsing looks letters up here instead of calling the locale aware character functions
+static constexpr array<uint8_t, 128> PieceCodes = makePieceCodes();
+
+// Castling rights lost when a piece moves from or to each square
+static uint8_t castlingMask(int square) {
+    switch (square) {
+        case 0: return WHITE_OOO; // a1
+        case 4: return WHITE_OO | WHITE_OOO; // e1
+        case 7: return WHITE_OO; // h1
+        case 56: return BLACK_OOO; // a8
+        case 60: return BLACK_OO | BLACK_OOO; // e8
+        case 63: return BLACK_OO; // h8
+        default: return NO_CASTLING;
+    }
+}
+
+/**
+ * @brief Random keys for every feature of a position, xored together to form its Zobrist key.
+ */
+struct ZobristKeys {
+    Key psq[COLOR_NB][PIECE_TYPE_NB][64]; // Piece of a side on a square
+    Key castling[ALL_CASTLING + 1]; // Castling rights combination
+    Key enPassant[8]; // En passant file
+    Key side; // Black to move
+};
+
+/**
+ * @brief Advances a xorshift64* generator, usable at compile time.
+ */
+static constexpr Key nextRandom(Key& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+static constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys = {};
+    Key state = 1070372;
+    for (int c = 0; c < COLOR_NB; ++c) {
+        for (int pt = 0; pt < PIECE_TYPE_NB; ++pt) {
+            for (int square = 0; square < 64; ++square) {
+                keys.psq[c][pt][square] = nextRandom(state);
+            }
+        }
+    }
+    for (int i = 0; i <= ALL_CASTLING; ++i) {
+        keys.castling[i] = nextRandom(state);
+    }
+    for (int file = 0; file < 8; ++file) {
+        keys.enPassant[file] = nextRandom(state);
+    }
+    keys.side = nextRandom(state);
+    return keys;
+}
+
+// Built at compile time so keys are valid even for positions set up before main()
+static constexpr ZobristKeys Zobrist = makeZobristKeys();
+
+Position::Position() : side(WHITE), castling(NO_CASTLING), ep(NO_SQUARE), halfmove(0), fullmove(1), hash(0) {
+    for (int i = 0; i < PIECE_TYPE_NB; ++i) {
+        byType[i] = 0;
+    }
+    byColor[WHITE] = byColor[BLACK] = 0;
+}
+
+void Position::putPiece(Color c, PieceType pt, int square) {
+    byType[pt] |= squareBB(square);
+    byColor[c] |= squareBB(square);
+    hash ^= Zobrist.psq[c][pt][square];
+}
+
+void Position::removePiece(int square) {
+    PieceType pt = typeOn(square);
+    if (pt != NO_PIECE_TYPE) {
+        hash ^= Zobrist.psq[colorOn(square)][pt][square];
+    }
+    Bitboard mask = ~squareBB(square);
+    for (int i = 0; i < PIECE_TYPE_NB; ++i) {
+        byType[i] &= mask;
+    }
+    byColor[WHITE] &= mask;
+    byColor[BLACK] &= mask;
+}
+
+PieceType Position::typeOn(int square) const {
+    Bitboard b = squareBB(square);
+    for (int i = 0; i < PIECE_TYPE_NB; ++i) {
+        if (byType[i] & b) {
+            return PieceType(i);
+        }
+    }
+    return NO_PIECE_TYPE;
+}
+
+int Position::kingSquare(Color c) const {
+    Bitboard king = pieces(c, KING);
+    return king ? lsb(king) : NO_SQUARE;
+}
+
+/**
+ * @brief Reads a decimal number from FEN text.
+ * @param p The read pointer, advanced past the digits.
+ * @param end The end of the text.
+ * @param value Set to the number, clamped to the range of the clock fields.
+ * @return True if at least one digit was read, false otherwise.
+ */
+static bool parseNumber(const char*& p, const char* end, int& value) {
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = min(value * 10 + (*p++ - '0'), 0xFFFF);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a decimal number, returning the position after its last digit.
+ */
+static char* writeNumber(char* out, unsigned value) {
+    char digits[5];
+    int count = 0;
+    do {
+        digits[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (count) {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+bool Position::set(const char* fen, size_t length) {
+    // Parsing into a fresh position leaves this one as it was when the text is rejected
+    Position parsed;
+    if (!parsed.parse(fen, length)) {
+        return false;
+    }
+    *this = parsed;
+    return true;
+}
+
+bool Position::parse(const char* fen, size_t length) {
+    const char* p = fen;
+    const char* end = fen + length;
+    auto skipSpaces = [&]() { while (p < end && *p == ' ') ++p; };
+    auto fieldEnd = [&]() { const char* q = p; while (q < end && *q != ' ') ++q; return q; };
+
+    skipSpaces();
+    if (p == end) {
+        return false;
+    }
+
+    // Piece placement starts at a8 and runs rank by rank down to h1
+    int file = 0;
+    int rank = 7;
+    for (const char* boardEnd = fieldEnd(); p < boardEnd; ++p) {
+        char c = *p;
+        if (c == '/') {
+            if (file != 8 || rank == 0) {
+                return false;
+            }
+            file = 0;
+            --rank;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) {
+                return false;
+            }
+        } else {
+            int piece = (static_cast<unsigned char>(c) < 128) ? PieceCodes[int(c)] : 0;
+            if (piece == 0 || file > 7) {
+                return false;
+            }
+            putPiece(Color(piece >> 3), PieceType((piece & 7) - 1), makeSquare(file, rank));
+            ++file;
+        }
+    }
+    if (rank != 0 || file != 8 || popCount(pieces(WHITE, KING)) != 1 || popCount(pieces(BLACK, KING)) != 1) {
+        return false;
+    }
+
+    skipSpaces();
+    const char* sideEnd = fieldEnd();
+    if (sideEnd - p != 1 || (*p != 'w' && *p != 'b')) {
+        return false;
+    }
+    side = (*p == 'b') ? BLACK : WHITE;
+    p = sideEnd;
+
+    skipSpaces();
+    for (const char* castlingEnd = fieldEnd(); p < castlingEnd; ++p) {
+        if (*p == 'K') castling |= WHITE_OO;
+        if (*p == 'Q') castling |= WHITE_OOO;
+        if (*p == 'k') castling |= BLACK_OO;
+        if (*p == 'q') castling |= BLACK_OOO;
+    }
+
+    skipSpaces();
+    const char* epEnd = fieldEnd();
+    if (epEnd - p == 2 && p[0] >= 'a' && p[0] <= 'h' && p[1] >= '1' && p[1] <= '8') {
+        // The square is behind a pawn that just moved two squares, so it is on the mover's third rank
+        if (p[1] != ((side == WHITE) ? '6' : '3')) {
+            return false;
+        }
+        ep = makeSquare(p[0] - 'a', p[1] - '1');
+    } else if (epEnd != p && !(epEnd - p == 1 && *p == '-')) {
+        return false;
+    }
+    p = epEnd;
+
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+    skipSpaces();
+    if (parseNumber(p, end, halfmoveClock)) {
+        skipSpaces();
+        parseNumber(p, end, fullmoveNumber);
+    }
+    halfmove = halfmoveClock;
+    fullmove = max(fullmoveNumber, 1);
+    finishSetup();
+    return true;
+}
+
+void Position::finishSetup() {
+    // Keep the en passant square only if a pawn can capture there, as applyMove does, so keys match
+    if (ep != NO_SQUARE && !(PawnAttacks[~side][ep] & pieces(side, PAWN))) {
+        ep = NO_SQUARE;
+    }
+
+    // Pieces were hashed while placing them, add the remaining state
+    hash ^= Zobrist.castling[castling];
+    if (ep != NO_SQUARE) {
+        hash ^= Zobrist.enPassant[fileOf(ep)];
+    }
+    if (side == BLACK) {
+        hash ^= Zobrist.side;
+    }
+}
+
+size_t Position::writeFen(char* buffer, size_t size) const {
+    if (size < FEN_BUFFER_SIZE) {
+        return 0;
+    }
+
+    // Fill a mailbox from the bitboards once instead of looking up the piece on every square
+    char letters[64] = {};
+    for (int pt = PAWN; pt < PIECE_TYPE_NB; ++pt) {
+        Bitboard white = pieces(WHITE, PieceType(pt));
+        Bitboard black = pieces(BLACK, PieceType(pt));
+        while (white) {
+            letters[popLsb(white)] = char(PieceChars[pt] - 'a' + 'A');
+        }
+        while (black) {
+            letters[popLsb(black)] = PieceChars[pt];
+        }
+    }
+
+    char* out = buffer;
+    for (int rank = 7; rank >= 0; --rank) {
+        int emptyCount = 0;
+        for (int file = 0; file < 8; ++file) {
+            char c = letters[makeSquare(file, rank)];
+            if (!c) {
+                emptyCount++;
+                continue;
+            }
+            if (emptyCount > 0) {
+                *out++ = char('0' + emptyCount);
+                emptyCount = 0;
+            }
+            *out++ = c;
+        }
+        if (emptyCount > 0) {
+            *out++ = char('0' + emptyCount);
+        }
+        if (rank > 0) {
+            *out++ = '/';
+        }
+    }
+
+    *out++ = ' ';
+    *out++ = (side == WHITE) ? 'w' : 'b';
+    *out++ = ' ';
+    if (castling == NO_CASTLING) {
+        *out++ = '-';
+    } else {
+        if (castling & WHITE_OO) *out++ = 'K';
+        if (castling & WHITE_OOO) *out++ = 'Q';
+        if (castling & BLACK_OO) *out++ = 'k';
+        if (castling & BLACK_OOO) *out++ = 'q';
+    }
+    *out++ = ' ';
+    if (ep == NO_SQUARE) {
+        *out++ = '-';
+    } else {
+        *out++ = squareName(ep)[0];
+        *out++ = squareName(ep)[1];
+    }
+    *out++ = ' ';
+    out = writeNumber(out, halfmove);
+    *out++ = ' ';
+    out = writeNumber(out, fullmove);
+    *out = '\0';
+    return out - buffer;
+}
+
+string Position::fen() const {
+    char buffer[FEN_BUFFER_SIZE];
+    return string(buffer, writeFen(buffer, sizeof(buffer)));
+}
+
+bool Position::pack(PackedPosition& packed) const {
+    Bitboard occupied = pieces();
+    if (popCount(occupied) > 32) {
+        return false;
+    }
+
+    memset(packed.bytes, 0, sizeof(packed.bytes));
+    for (int i = 0; i < 8; ++i) {
+        packed.bytes[i] = uint8_t(occupied >> (8 * i));
+    }
+    for (int index = 0; occupied; ++index) {
+        int square = popLsb(occupied);
+        uint8_t code = (colorOn(square) << 3) | typeOn(square);
+        packed.bytes[8 + index / 2] |= code << (4 * (index % 2));
+    }
+    packed.bytes[24] = side | (castling << 1);
+    packed.bytes[25] = ep;
+    packed.bytes[26] = uint8_t(halfmove);
+    packed.bytes[27] = uint8_t(halfmove >> 8);
+    packed.bytes[28] = uint8_t(fullmove);
+    packed.bytes[29] = uint8_t(fullmove >> 8);
+    return true;
+}
+
+bool Position::unpack(const PackedPosition& packed) {
+    *this = Position();
+    Bitboard occupied = 0;
+    for (int i = 0; i < 8; ++i) {
+        occupied |= Bitboard(packed.bytes[i]) << (8 * i);
+    }
+    int count = popCount(occupied);
+    if (count > 32 || (packed.bytes[24] >> 5) || packed.bytes[25] > NO_SQUARE || packed.bytes[30] || packed.bytes[31]) {
+        return false;
+    }
+    // Unused nibbles are zero too, so every position has exactly one encoding
+    for (int index = count; index < 32; ++index) {
+        if ((packed.bytes[8 + index / 2] >> (4 * (index % 2))) & 15) {
+            return false;
+        }
+    }
+
+    for (int index = 0; occupied; ++index) {
+        int square = popLsb(occupied);
+        uint8_t code = (packed.bytes[8 + index / 2] >> (4 * (index % 2))) & 15;
+        if ((code & 7) >= PIECE_TYPE_NB) {
+            *this = Position();
+            return false;
+        }
+        putPiece(Color(code >> 3), PieceType(code & 7), square);
+    }
+    side = Color(packed.bytes[24] & 1);
+    castling = packed.bytes[24] >> 1;
+    ep = packed.bytes[25];
+    halfmove = packed.bytes[26] | (packed.bytes[27] << 8);
+    fullmove = max(packed.bytes[28] | (packed.bytes[29] << 8), 1);
+    finishSetup();
+    return true;
+}
+
+Bitboard Position::attackersTo(int square, Bitboard occupied) const {
+    return (PawnAttacks[BLACK][square] & pieces(WHITE, PAWN))
+         | (PawnAttacks[WHITE][square] & pieces(BLACK, PAWN))
+         | (KnightAttacks[square] & byType[KNIGHT])
+         | (KingAttacks[square] & byType[KING])
+         | (rookAttacks(square, occupied) & (byType[ROOK] | byType[QUEEN]))
+         | (bishopAttacks(square, occupied) & (byType[BISHOP] | byType[QUEEN]));
+}
+
+bool Position::isAttacked(int square, Color by) const {
+    return attackersTo(square, pieces()) & byColor[by];
+}
+
+bool Position::inCheck(Color c) const {
+    int king = kingSquare(c);
+    return king != NO_SQUARE && isAttacked(king, ~c);
+}
+
+bool Position::isCastling(int from, int to) const {
+    return (pieces(KING) & squareBB(from)) && abs(fileOf(from) - fileOf(to)) == 2;
+}
+
+bool Position::isEnPassant(int from, int to) const {
+    return (pieces(PAWN) & squareBB(from)) && to == ep;
+}
+
+template <Color Us>
+Bitboard Position::castlingKingPath(bool kingside) const {
+    constexpr int KingFrom = (Us == WHITE) ? 4 : 60;
+    constexpr uint8_t KingsideRight = (Us == WHITE) ? WHITE_OO : BLACK_OO;
+    constexpr uint8_t QueensideRight = (Us == WHITE) ? WHITE_OOO : BLACK_OOO;
+    if (!(castling & (kingside ? KingsideRight : QueensideRight))) {
+        return 0;
+    }
+
+    int rookFrom = KingFrom + (kingside ? 3 : -4);
+    if (!(pieces(Us, KING) & squareBB(KingFrom)) || !(pieces(Us, ROOK) & squareBB(rookFrom))) {
+        return 0;
+    }
+
+    // Squares between king and rook must be empty
+    if (BetweenBB[KingFrom][rookFrom] & pieces()) {
+        return 0;
+    }
+
+    int kingTo = KingFrom + (kingside ? 2 : -2);
+    return BetweenBB[KingFrom][kingTo] | squareBB(KingFrom) | squareBB(kingTo);
+}
+
+template <Color Us>
+bool Position::canCastle(bool kingside, Bitboard enemyAttacks) const {
+    Bitboard path = castlingKingPath<Us>(kingside);
+    return path && !(path & enemyAttacks);
+}
+
+template <Color Us>
+bool Position::canCastle(bool kingside) const {
+    // The king may not castle out of, through or into check
+    Bitboard path = castlingKingPath<Us>(kingside);
+    if (!path) {
+        return false;
+    }
+    while (path) {
+        if (isAttacked(popLsb(path), ~Us)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template bool Position::canCastle<WHITE>(bool kingside) const;
+template bool Position::canCastle<BLACK>(bool kingside) const;
+template bool Position::canCastle<WHITE>(bool kingside, Bitboard enemyAttacks) const;
+template bool Position::canCastle<BLACK>(bool kingside, Bitboard enemyAttacks) const;
+
+bool Position::isPseudoLegal(int from, int to) const {
+    if (from < 0 || from >= 64 || to < 0 || to >= 64 || from == to) {
+        return false;
+    }
+    if (!(pieces(side) & squareBB(from)) || (pieces(side) & squareBB(to))) {
+        return false;
+    }
+
+    Bitboard target = squareBB(to);
+    switch (typeOn(from)) {
+        case PAWN: {
+            int forward = (side == WHITE) ? 8 : -8;
+            int startRank = (side == WHITE) ? 1 : 6;
+            if (to == from + forward) {
+                return empty(to);
+            }
+            if (to == from + 2 * forward) {
+                return rankOf(from) == startRank && empty(from + forward) && empty(to);
+            }
+            return (PawnAttacks[side][from] & target) && (!empty(to) || to == ep);
+        }
+        case KNIGHT:
+            return KnightAttacks[from] & target;
+        case BISHOP:
+            return bishopAttacks(from, pieces()) & target;
+        case ROOK:
+            return rookAttacks(from, pieces()) & target;
+        case QUEEN:
+            return (rookAttacks(from, pieces()) | bishopAttacks(from, pieces())) & target;
+        case KING:
+            if (isCastling(from, to)) {
+                return rankOf(from) == rankOf(to) && ((side == WHITE) ? canCastle<WHITE>(to > from) : canCastle<BLACK>(to > from));
+            }
+            return KingAttacks[from] & target;
+        default:
+            return false;
+    }
+}
+
+Bitboard Position::checkers() const {
+    int king = kingSquare(side);
+    return (king == NO_SQUARE) ? 0 : attackersTo(king, pieces()) & pieces(~side);
+}
+
+Bitboard Position::pinned() const {
+    int king = kingSquare(side);
+    if (king == NO_SQUARE) {
+        return 0;
+    }
+
+    // Enemy sliders that would attack the king on an empty board pin the single piece in between
+    Bitboard snipers = (rookAttacks(king, 0) & (pieces(~side, ROOK) | pieces(~side, QUEEN)))
+                     | (bishopAttacks(king, 0) & (pieces(~side, BISHOP) | pieces(~side, QUEEN)));
+    Bitboard result = 0;
+    while (snipers) {
+        Bitboard blockers = BetweenBB[king][popLsb(snipers)] & pieces();
+        if (blockers && !moreThanOne(blockers) && (blockers & pieces(side))) {
+            result |= blockers;
+        }
+    }
+    return result;
+}
+
+bool Position::keepsKingSafe(int from, int to, Bitboard pinnedPieces, Bitboard checkingPieces) const {
+    int king = kingSquare(side);
+    if (king == NO_SQUARE) {
+        return true;
+    }
+
+    // The king may not step onto an attacked square, looking through its own square for sliders
+    if (from == king) {
+        return isCastling(from, to) || !(attackersTo(to, pieces() ^ squareBB(from)) & pieces(~side));
+    }
+
+    // Only a king move answers a double check
+    if (moreThanOne(checkingPieces)) {
+        return false;
+    }
+
+    // En passant removes two pieces from a line, so look at the resulting occupancy directly
+    if (to == ep && (pieces(PAWN) & squareBB(from))) {
+        Bitboard captured = squareBB(to + ((side == WHITE) ? -8 : 8));
+        Bitboard occupied = (pieces() ^ squareBB(from) ^ captured) | squareBB(to);
+        return !(attackersTo(king, occupied) & pieces(~side) & ~captured);
+    }
+
+    // A check must be captured or blocked
+    if (checkingPieces) {
+        int checker = lsb(checkingPieces);
+        if (!((BetweenBB[king][checker] | checkingPieces) & squareBB(to))) {
+            return false;
+        }
+    }
+
+    // A pinned piece may only move along the pin
+    return !(pinnedPieces & squareBB(from)) || (LineBB[king][from] & squareBB(to));
+}
+
+bool Position::isLegal(int from, int to) const {
+    return isPseudoLegal(from, to) && keepsKingSafe(from, to, pinned(), checkers());
+}
+
+void Position::applyMove(int from, int to, PieceType promotion) {
+    Color us = side;
+    PieceType pt = typeOn(from);
+    PieceType captured = typeOn(to);
+
+    halfmove = (pt == PAWN || captured != NO_PIECE_TYPE) ? 0 : halfmove + 1;
+
+    if (pt == PAWN && to == ep) {
+        removePiece(to + ((us == WHITE) ? -8 : 8));
+    }
+    if (captured != NO_PIECE_TYPE) {
+        removePiece(to);
+    }
+    removePiece(from);
+
+    if (pt == PAWN && (rankOf(to) == 7 || rankOf(to) == 0)) {
+        if (promotion == PAWN || promotion == KING || promotion == NO_PIECE_TYPE) {
+            promotion = QUEEN;
+        }
+        putPiece(us, promotion, to);
+    } else {
+        putPiece(us, pt, to);
+    }
+
+    // Castling hops the rook over the king
+    if (pt == KING && abs(fileOf(from) - fileOf(to)) == 2) {
+        int rookFrom = (to > from) ? from + 3 : from - 4;
+        int rookTo = (to > from) ? from + 1 : from - 1;
+        removePiece(rookFrom);
+        putPiece(us, ROOK, rookTo);
+    }
+
+    hash ^= Zobrist.castling[castling];
+    castling &= ~(castlingMask(from) | castlingMask(to));
+    hash ^= Zobrist.castling[castling];
+
+    // Only record an en passant square when an enemy pawn can actually capture there
+    if (ep != NO_SQUARE) {
+        hash ^= Zobrist.enPassant[fileOf(ep)];
+    }
+    ep = NO_SQUARE;
+    if (pt == PAWN && abs(to - from) == 16) {
+        int skipped = (from + to) / 2;
+        if (PawnAttacks[us][skipped] & pieces(~us, PAWN)) {
+            ep = skipped;
+            hash ^= Zobrist.enPassant[fileOf(ep)];
+        }
+    }
+
+    if (us == BLACK) {
+        fullmove++;
+    }
+    side = ~us;
+    hash ^= Zobrist.side;
+}
+
+void Position::makeMove(Move move, UndoInfo& undo) {
+    // applyMove reads the kind of move from the board too, so a Move built from its squares alone is taken back right
+    int from = move.from();
+    int to = move.to();
+    if (isCastling(from, to)) {
+        undo.flag = CASTLING_MOVE;
+    } else if (isEnPassant(from, to)) {
+        undo.flag = EN_PASSANT_MOVE;
+    } else if ((pieces(PAWN) & squareBB(from)) && (rankOf(to) == 7 || rankOf(to) == 0)) {
+        undo.flag = PROMOTION_MOVE;
+    } else {
+        undo.flag = NORMAL_MOVE;
+    }
+    undo.captured = (undo.flag == EN_PASSANT_MOVE) ? NO_PIECE_TYPE : typeOn(to);
+    undo.castling = castling;
+    undo.ep = ep;
+    undo.halfmove = halfmove;
+    undo.key = hash;
+    applyMove(move);
+}
+
+void Position::unmakeMove(Move move, const UndoInfo& undo) {
+    Color us = ~side;
+    int from = move.from();
+    int to = move.to();
+
+    if (undo.flag == CASTLING_MOVE) {
+        int rookFrom = (to > from) ? from + 3 : from - 4;
+        int rookTo = (to > from) ? from + 1 : from - 1;
+        removePiece(rookTo);
+        putPiece(us, ROOK, rookFrom);
+    }
+
+    // A promoted piece goes back as the pawn it was
+    PieceType moved = (undo.flag == PROMOTION_MOVE) ? PAWN : typeOn(to);
+    removePiece(to);
+    putPiece(us, moved, from);
+
+    if (undo.flag == EN_PASSANT_MOVE) {
+        putPiece(~us, PAWN, to + ((us == WHITE) ? -8 : 8));
+    } else if (undo.captured != NO_PIECE_TYPE) {
+        putPiece(~us, undo.captured, to);
+    }
+
+    castling = undo.castling;
+    ep = undo.ep;
+    halfmove = undo.halfmove;
+    hash = undo.key;
+    if (us == BLACK) {
+        fullmove--;
+    }
+    side = us;
+}
+
+string squareToNotation(int square) {
+    return squareName(square);
+}
+
+int notationToSquare(const string& notation) {
+    if (notation.length() < 2 || notation[0] < 'a' || notation[0] > 'h' || notation[1] < '1' || notation[1] > '8') {
+        return NO_SQUARE;
+    }
+    return makeSquare(notation[0] - 'a', notation[1] - '1');
+}
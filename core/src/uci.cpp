@@ -0,0 +1,48 @@
+#include "uci.h"
+#include <sstream>
+
+using namespace std;
+
+string uciPositionCommand(const Position& start, const vector<Move>& moves) {
+    // Games from the standard start are sent without a FEN at all
+    string startFen = start.fen();
+    string command = (startFen == START_FEN) ? "position startpos" : "position fen " + startFen;
+    if (!moves.empty()) {
+        command += " moves";
+        for (Move move : moves) {
+            command += " " + move.toString();
+        }
+    }
+    return command;
+}
+
+string uciGoCommand(const SearchLimits& limits, bool ponder) {
+    string command = ponder ? "go ponder" : "go";
+    if (limits.depth > 0) {
+        command += " depth " + to_string(limits.depth);
+    }
+    if (limits.moveTimeMs > 0) {
+        command += " movetime " + to_string(limits.moveTimeMs);
+    }
+    return command;
+}
+
+bool parseBestMove(const string& line, string& best, string& ponder) {
+    istringstream tokens(line);
+    string keyword, ponderKeyword;
+    best.clear();
+    ponder.clear();
+    tokens >> keyword >> best >> ponderKeyword >> ponder;
+    if (keyword != "bestmove" || best.empty()) {
+        best.clear();
+        ponder.clear();
+        return false;
+    }
+    if (best == "(none)") {
+        best.clear();
+    }
+    if (ponderKeyword != "ponder") {
+        ponder.clear();
+    }
+    return true;
+}
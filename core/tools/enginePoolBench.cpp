@@ -0,0 +1,119 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include "enginePool.h"
+#include "movegen.h"
+#include "gameStatus.h"
+
+using namespace std;
+
+/**
+ * @brief Returns a percentile of sorted values.
+ */
+static double percentile(const vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[min(sorted.size() - 1, size_t(fraction * sorted.size()))];
+}
+
+/**
+ * @brief Prints the distribution of one kind of time.
+ */
+static void printTimes(const string& name, vector<double> times) {
+    sort(times.begin(), times.end());
+    double total = 0;
+    for (double t : times) {
+        total += t;
+    }
+    cout << name << ": mean " << setw(8) << (times.empty() ? 0 : total / times.size())
+         << " ms, p50 " << setw(8) << percentile(times, 0.5)
+         << " ms, p95 " << setw(8) << percentile(times, 0.95)
+         << " ms, max " << setw(8) << (times.empty() ? 0 : times.back()) << " ms" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    EngineOptions options;
+    options.depth = 8;
+    int engines = 2;
+    int clients = 4;
+    int plies = 40;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-e" && i + 1 < argc) {
+            engines = max(1, stoi(argv[++i]));
+        } else if (arg == "-c" && i + 1 < argc) {
+            clients = max(1, stoi(argv[++i]));
+        } else if (arg == "-p" && i + 1 < argc) {
+            plies = max(1, stoi(argv[++i]));
+        } else if (arg == "-d" && i + 1 < argc) {
+            options.depth = max(1, stoi(argv[++i]));
+        } else if (arg == "-t" && i + 1 < argc) {
+            options.threads = max(1, stoi(argv[++i]));
+        } else if (arg == "-h" && i + 1 < argc) {
+            options.hashMb = max(1, stoi(argv[++i]));
+        } else {
+            options.path = arg;
+        }
+    }
+    if (options.path.empty()) {
+        cerr << "Usage: " << argv[0] << " <engine> [-e engines] [-c clients] [-p plies] [-d depth] [-t threads] [-h hash MB]" << endl;
+        return 1;
+    }
+
+    initBitboards();
+    EnginePool pool;
+    auto warmStart = chrono::steady_clock::now();
+    if (!pool.start(options, engines)) {
+        return 1;
+    }
+    cout << fixed << setprecision(1) << "Started " << pool.size() << " engines in "
+         << chrono::duration<double, milli>(chrono::steady_clock::now() - warmStart).count() << " ms" << endl;
+
+    // Every client plays a game against itself, all clients at once, so jobs queue for the engines
+    Position start;
+    start.set(START_FEN);
+    mutex timesMutex;
+    vector<double> queueWaits, searchTimes;
+    vector<thread> games;
+    auto runStart = chrono::steady_clock::now();
+    for (int client = 0; client < clients; ++client) {
+        games.emplace_back([&, client]() {
+            Position pos = start;
+            vector<Move> moves;
+            vector<Key> keys(1, pos.key());
+            for (int ply = 0; ply < plies; ++ply) {
+                if (computeGameStatus(pos, keys).gameOver()) {
+                    break;
+                }
+                EngineResult result = pool.submit(client, start, moves).get();
+                if (result.move.isNone()) {
+                    break;
+                }
+                {
+                    lock_guard<mutex> lock(timesMutex);
+                    queueWaits.push_back(result.queueWaitMs);
+                    searchTimes.push_back(result.searchMs);
+                }
+                pos.applyMove(result.move);
+                moves.push_back(result.move);
+                keys.push_back(pos.key());
+            }
+        });
+    }
+    for (thread& game : games) {
+        game.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+
+    EnginePoolStats stats = pool.getStats();
+    cout << stats.searched << " searches for " << clients << " clients on " << pool.size() << " engines in "
+         << seconds << " s, " << stats.searched / seconds << " searches/s" << endl;
+    printTimes("Queue wait", queueWaits);
+    printTimes("Search    ", searchTimes);
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "engineProcess.h"
+#include "enginePool.h"
+#include "bitboard.h"
+#include "movegen.h"
+#include "uci.h"
+
+using namespace std;
+
+static int failures = 0;
+
+/**
+ * @brief Prints the outcome of one check and counts it if it failed.
+ */
+static void check(bool passed, const string& name) {
+    cout << (passed ? "ok      " : "FAILED  ") << name << endl;
+    if (!passed) {
+        failures++;
+    }
+}
+
+/**
+ * @brief Returns the milliseconds since a time.
+ */
+static double elapsedMs(chrono::steady_clock::time_point since) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * @brief Returns whether every child of this process was reaped.
+ */
+static bool noChildrenLeft() {
+    return waitpid(-1, nullptr, WNOHANG) < 0 && errno == ECHILD;
+}
+
+/**
+ * @brief Returns whether a SIGPIPE is waiting to be delivered to this thread.
+ */
+static bool sigpipePending() {
+    sigset_t pending;
+    sigpending(&pending);
+    return sigismember(&pending, SIGPIPE);
+}
+
+int main(int argc, char* argv[]) {
+    // The fake engine is built next to this program
+    string engine = string(argv[0]).substr(0, string(argv[0]).find_last_of('/') + 1) + "chess_fake_engine";
+    if (argc > 1) {
+        engine = argv[1];
+    }
+    string line, best, ponder;
+
+    // A well behaved engine answers the handshake and a search
+    {
+        EngineProcess process;
+        check(process.start(engine, {"normal", "crlf"}), "normal: starts");
+        process.send("uci");
+        check(process.waitFor("uciok", line, 1000) && line == "uciok", "normal: uciok with CRLF line ends");
+        process.send("go depth 1");
+        check(process.waitFor("bestmove", line, 1000) && parseBestMove(line, best, ponder)
+              && best == "e2e4" && ponder == "e7e5", "normal: bestmove with ponder");
+        process.send("quit");
+        auto start = chrono::steady_clock::now();
+        process.stop();
+        check(elapsedMs(start) < 400 && !process.running(), "normal: quits on its own");
+    }
+    check(noChildrenLeft(), "normal: reaped");
+
+    // A missing executable fails cleanly
+    {
+        EngineProcess process;
+        check(!process.start(engine + ".missing"), "missing: start fails");
+        check(!process.running() && !process.send("uci"), "missing: nothing to talk to");
+    }
+    check(noChildrenLeft(), "missing: nothing left to reap");
+
+    // A read from an engine that stays silent gives up after its timeout
+    {
+        EngineProcess process;
+        process.start(engine, {"hang"});
+        process.send("go infinite");
+        auto start = chrono::steady_clock::now();
+        bool read = process.readLine(line, 200);
+        double waited = elapsedMs(start);
+        check(!read && waited >= 190 && waited < 1000, "hang: read times out after " + to_string(int(waited)) + " ms");
+        check(process.running(), "hang: still running after the timeout");
+        start = chrono::steady_clock::now();
+        process.stop(100);
+        check(elapsedMs(start) < 400 && !process.running(), "hang: stopped by closing its input");
+    }
+    check(noChildrenLeft(), "hang: reaped");
+
+    // An engine that exits ends reads at once
+    {
+        EngineProcess process;
+        process.start(engine, {"crash"});
+        process.send("uci");
+        check(process.waitFor("uciok", line, 1000), "crash: answers uci");
+        process.send("go depth 1");
+        auto start = chrono::steady_clock::now();
+        bool read = process.readLine(line, 2000);
+        check(!read && elapsedMs(start) < 1000, "crash: read ends at end of output");
+        start = chrono::steady_clock::now();
+        while (process.running() && elapsedMs(start) < 1000) {}
+        check(!process.running(), "crash: reaped by running");
+    }
+    check(noChildrenLeft(), "crash: reaped");
+
+    // The pipes stay open until the exit is noticed, so writes go to a pipe nobody reads
+    {
+        EngineProcess process;
+        process.start(engine, {"crash"});
+        process.send("go");
+        string discard;
+        process.readLine(discard, 1000);
+        // Output can reach its end a moment before the exiting engine closes its input
+        this_thread::sleep_for(chrono::milliseconds(100));
+        bool sent = true;
+        for (int i = 0; i < 8 && sent; ++i) {
+            sent = process.send("isready");
+        }
+        // This program keeps the default SIGPIPE action, which would have killed it
+        struct sigaction action;
+        sigaction(SIGPIPE, nullptr, &action);
+        check(!sent, "broken pipe: send fails");
+        check(!sigpipePending() && action.sa_handler == SIG_DFL, "broken pipe: no SIGPIPE, default action untouched");
+    }
+    check(noChildrenLeft(), "broken pipe: reaped");
+
+    // Waiting for a search ends with its bestmove, also after an early stop, or reports an engine that exited or hung
+    {
+        EngineProcess process;
+        process.start(engine, {"normal"});
+        process.send("go depth 1");
+        check(process.waitBestMove(line, []() { return false; }, 1000, 200, 10) == SEARCH_FINISHED
+              && parseBestMove(line, best, ponder) && best == "e2e4", "search: finished");
+        process.start(engine, {"crash"});
+        process.send("go depth 1");
+        check(process.waitBestMove(line, []() { return false; }, 1000, 200, 10) == SEARCH_EXITED, "search: engine exited");
+        process.start(engine, {"hang"});
+        process.send("go infinite");
+        auto start = chrono::steady_clock::now();
+        SearchOutcome outcome = process.waitBestMove(line, [&]() { return elapsedMs(start) > 50; }, 1000, 200, 10);
+        double waited = elapsedMs(start);
+        check(outcome == SEARCH_HUNG && waited >= 240 && waited < 1000 && !process.running(),
+              "search: unanswered stop after " + to_string(int(waited)) + " ms");
+    }
+    check(noChildrenLeft(), "search: reaped");
+
+    // A ponder search holds its bestmove until the expected reply is played or the search is stopped
+    {
+        EngineProcess process;
+        process.start(engine, {"ponder"});
+        process.send("go ponder depth 1");
+        check(!process.waitFor("bestmove", line, 200), "ponder: no bestmove while pondering");
+        process.send("ponderhit");
+        check(process.waitFor("bestmove", line, 1000) && parseBestMove(line, best, ponder) && best == "e2e4",
+              "ponder: bestmove after ponderhit");
+        process.send("go ponder depth 1");
+        process.send("stop");
+        check(process.waitFor("bestmove", line, 1000), "ponder: bestmove after stop");
+    }
+    check(noChildrenLeft(), "ponder: reaped");
+
+    // A pool ponders between a client's jobs, continuing on the expected reply and stopping on another
+    {
+        initBitboards();
+        EnginePool pool;
+        EngineOptions options;
+        options.path = engine;
+        options.args = {"ponder"};
+        check(pool.start(options, 1), "pool ponder: starts");
+        EngineJobOptions jobOptions;
+        jobOptions.ponder = true;
+        Position start;
+        start.set(START_FEN);
+        EngineResult first = pool.submit(0, start, {}, {}, jobOptions).get();
+        Position next = start;
+        UndoInfo undo;
+        next.makeMove(first.move, undo);
+        check(first.ponder == parseUciMove(next, "e7e5"), "pool ponder: expected reply");
+        // The fake engine plays e2e4 again, which is illegal here, so only the ponderhit is checked
+        auto sent = chrono::steady_clock::now();
+        EngineJob hit = pool.submit(0, start, {first.move, first.ponder}, {}, jobOptions);
+        check(hit.get().move.isNone() && elapsedMs(sent) < 1000 && pool.getStats().ponderHits == 1, "pool ponder: ponderhit");
+        pool.submit(0, start, {}, {}, jobOptions).get();
+        pool.submit(0, start, {first.move, parseUciMove(next, "d7d5")}, {}, jobOptions).get();
+        EnginePoolStats stats = pool.getStats();
+        check(stats.ponderHits == 1 && stats.ponderMisses == 1 && stats.searched == 4, "pool ponder: miss stops the ponder search");
+    }
+    check(noChildrenLeft(), "pool ponder: reaped");
+
+    // An engine that ignores end of input and SIGTERM is killed
+    {
+        EngineProcess process;
+        process.start(engine, {"stubborn"});
+        process.send("uci");
+        check(process.waitFor("uciok", line, 1000), "stubborn: answers uci");
+        auto start = chrono::steady_clock::now();
+        process.stop(100);
+        double waited = elapsedMs(start);
+        check(waited >= 190 && waited < 1000 && !process.running(), "stubborn: killed after " + to_string(int(waited)) + " ms");
+    }
+    check(noChildrenLeft(), "stubborn: reaped");
+
+    cout << (failures ? to_string(failures) + " checks failed" : "All checks passed") << endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "epdReader.h"
+#include "movegen.h"
+
+using namespace std;
+
+/**
+ * @brief Writes an EPD file of positions from random games, for runs without a file of real positions.
+ * @param path The path to write to.
+ * @param lines The number of positions to write.
+ * @return True if the file was written, false otherwise.
+ */
+static bool writeRandomEpd(const string& path, size_t lines) {
+    ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    Position pos;
+    pos.set(START_FEN);
+    int ply = 0;
+    char fen[FEN_BUFFER_SIZE];
+    for (size_t i = 0; i < lines; ++i) {
+        MoveList list;
+        generateLegalMoves(pos, list);
+        if (list.empty() || ply >= 200) {
+            pos.set(START_FEN);
+            ply = 0;
+            generateLegalMoves(pos, list = MoveList());
+        }
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        Move move = list.moves[(state * 0x2545F4914F6CDD1DULL >> 32) % list.size()];
+
+        // EPD keeps the first four FEN fields and replaces the clocks with operations
+        size_t length = pos.writeFen(fen, sizeof(fen));
+        int spaces = 0;
+        size_t cut = 0;
+        while (cut < length && (fen[cut] != ' ' || ++spaces < 4)) {
+            ++cut;
+        }
+        out.write(fen, cut);
+        out << " bm " << move.toString() << "; id \"random." << i << "\";\n";
+
+        pos.applyMove(move);
+        ++ply;
+    }
+    return bool(out);
+}
+
+int main(int argc, char* argv[]) {
+    string path;
+    int threads = max(1u, thread::hardware_concurrency());
+    size_t lines = 1000000;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) {
+            threads = max(1, stoi(argv[++i]));
+        } else if (arg == "-n" && i + 1 < argc) {
+            lines = stoul(argv[++i]);
+        } else {
+            path = arg;
+        }
+    }
+
+    initBitboards();
+    bool generated = path.empty();
+    if (generated) {
+        char temp[] = "/tmp/chess_epd_bench_XXXXXX";
+        int fd = mkstemp(temp);
+        if (fd < 0) {
+            cerr << "Failed to create a temporary file." << endl;
+            return 1;
+        }
+        close(fd);
+        path = temp;
+        cout << "Writing " << lines << " random positions to " << path << endl;
+        if (!writeRandomEpd(path, lines)) {
+            cerr << "Failed to write " << path << endl;
+            return 1;
+        }
+    }
+
+    EpdReader reader;
+    if (!reader.open(path)) {
+        return 1;
+    }
+    double gigabytes = reader.size() / 1e9;
+    cout << fixed << setprecision(3) << "File: " << path << ", " << gigabytes << " GB" << endl;
+
+    // Character classification alone, single threaded, scalar against SIMD
+    size_t results[2][2] = {};
+    for (int simd = 0; simd < 2; ++simd) {
+        if (simd && !EpdReader::simdAvailable()) {
+            cout << "SIMD classification is not available in this build." << endl;
+            break;
+        }
+        reader.setSimd(simd);
+        auto start = chrono::high_resolution_clock::now();
+        results[simd][0] = reader.scan(results[simd][1]);
+        double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        cout << "Scan " << (simd ? "SIMD  " : "scalar") << ": " << setprecision(2) << setw(8)
+             << gigabytes / seconds << " GB/s, " << results[simd][0] << " lines, " << results[simd][1] << " boards" << endl;
+    }
+    if (EpdReader::simdAvailable() && (results[0][0] != results[1][0] || results[0][1] != results[1][1])) {
+        cerr << "Scalar and SIMD classification disagree." << endl;
+        return 1;
+    }
+
+    // Full parse into positions, batches spread over the worker threads
+    reader.setSimd(true);
+    reader.rewind();
+    atomic<size_t> positions(0);
+    atomic<size_t> invalid(0);
+    atomic<uint64_t> checksum(0);
+    auto start = chrono::high_resolution_clock::now();
+    reader.run(threads, [&](const EpdBatch& batch) {
+        uint64_t keys = 0;
+        for (const EpdRecord& record : batch.records) {
+            keys ^= record.position.key();
+        }
+        positions += batch.records.size();
+        invalid += batch.invalid;
+        checksum ^= keys;
+    });
+    double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cout << "Parse: " << setprecision(2) << setw(8) << gigabytes / seconds << " GB/s, "
+         << positions / seconds / 1e6 << " M positions/s, " << positions << " positions, "
+         << invalid << " invalid, " << threads << " threads" << endl;
+    cout << "Checksum: " << checksum << endl;
+
+    if (generated) {
+        remove(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * @brief How the fake engine misbehaves, chosen by its first argument.
+ */
+enum Script {
+    NORMAL, // Answers every command like a well behaved engine
+    PONDER, // Like NORMAL, but holds the bestmove of go ponder until ponderhit or stop, as real engines do
+    HANG, // Never answers go and ignores stop
+    CRASH, // Exits without a word when told to go
+    STUBBORN // Like HANG, but also survives end of input and SIGTERM, so only SIGKILL ends it
+};
+
+/**
+ * @brief Writes a line to standard output and flushes it, the way engines answer.
+ */
+static void answer(const string& line, bool crlf) {
+    cout << line << (crlf ? "\r\n" : "\n") << flush;
+}
+
+/**
+ * @brief Blocks forever, as a hung engine does.
+ */
+[[noreturn]] static void hang() {
+    while (true) {
+        this_thread::sleep_for(chrono::seconds(1));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Script script = NORMAL;
+    bool crlf = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "hang") {
+            script = HANG;
+        } else if (arg == "ponder") {
+            script = PONDER;
+        } else if (arg == "crash") {
+            script = CRASH;
+        } else if (arg == "stubborn") {
+            script = STUBBORN;
+        } else if (arg == "crlf") {
+            crlf = true;
+        } else if (arg != "normal") {
+            cerr << "Usage: " << argv[0] << " [normal|ponder|hang|crash|stubborn] [crlf]" << endl;
+            return 1;
+        }
+    }
+    if (script == STUBBORN) {
+        signal(SIGTERM, SIG_IGN);
+    }
+
+    string command;
+    bool pondering = false;
+    while (getline(cin, command)) {
+        if (command == "uci") {
+            answer("id name Fake Engine", crlf);
+            answer("uciok", crlf);
+        } else if (command == "isready") {
+            answer("readyok", crlf);
+        } else if (command.compare(0, 2, "go") == 0) {
+            if (script == CRASH) {
+                return 2;
+            }
+            if (script == NORMAL || script == PONDER) {
+                answer("info depth 1 score cp 20 pv e2e4", crlf);
+            }
+            pondering = script == PONDER && command.find(" ponder") != string::npos;
+            if (script == NORMAL || (script == PONDER && !pondering)) {
+                answer("bestmove e2e4 ponder e7e5", crlf);
+            }
+        } else if (command == "ponderhit") {
+            if (pondering) {
+                answer("bestmove e2e4 ponder e7e5", crlf);
+                pondering = false;
+            }
+        } else if (command == "stop") {
+            if (script == NORMAL || pondering) {
+                answer("bestmove e2e4", crlf);
+                pondering = false;
+            }
+        } else if (command == "quit") {
+            break;
+        }
+    }
+
+    // End of input or quit
+    if (script == STUBBORN) {
+        hang();
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstring>
+#include "position.h"
+
+using namespace std;
+
+struct BenchPosition {
+    string name;
+    string fen;
+};
+
+// Positions from the opening to the endgame, all written the way Position writes them
+static const vector<BenchPosition> positions = {
+    {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+    {"en passant", "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"},
+    {"middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"},
+    {"endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 12 57"},
+};
+
+/**
+ * @brief Returns the rate of a FEN operation in millions of calls per second.
+ */
+template <typename Operation>
+static double timeOperation(Operation operation, int iterations) {
+    auto start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        operation();
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return iterations / chrono::duration<double, micro>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = (argc > 1) ? stoi(argv[1]) : 1000000;
+    initBitboards();
+
+    cout << left << setw(14) << "position" << right << setw(14) << "parse (M/s)" << setw(18) << "serialize (M/s)"
+         << setw(16) << "string (M/s)" << setw(14) << "pack (M/s)" << setw(16) << "unpack (M/s)" << endl;
+
+    uint64_t checksum = 0;
+    for (const BenchPosition& bench : positions) {
+        Position pos;
+        char buffer[FEN_BUFFER_SIZE];
+        if (!pos.set(bench.fen) || bench.fen != string(buffer, pos.writeFen(buffer, sizeof(buffer)))) {
+            cerr << "FEN does not round trip for " << bench.name << endl;
+            return 1;
+        }
+        PackedPosition packed;
+        Position unpacked;
+        if (!pos.pack(packed) || !unpacked.unpack(packed) || unpacked.fen() != bench.fen || unpacked.key() != pos.key()) {
+            cerr << "Packed position does not round trip for " << bench.name << endl;
+            return 1;
+        }
+
+        // The checksum keeps the compiler from dropping the work
+        const char* text = bench.fen.c_str();
+        size_t length = bench.fen.size();
+        double parseRate = timeOperation([&]() { pos.set(text, length); checksum += pos.key(); }, iterations);
+        double serializeRate = timeOperation([&]() { checksum += pos.writeFen(buffer, sizeof(buffer)) + buffer[0]; }, iterations);
+        double stringRate = timeOperation([&]() { pos.set(bench.fen); checksum += pos.fen().size(); }, iterations);
+        double packRate = timeOperation([&]() { pos.pack(packed); checksum += packed.bytes[8]; }, iterations);
+        double unpackRate = timeOperation([&]() { unpacked.unpack(packed); checksum += unpacked.key(); }, iterations);
+
+        cout << left << setw(14) << bench.name << right << fixed << setprecision(2) << setw(14) << parseRate
+             << setw(18) << serializeRate << setw(16) << stringRate << setw(14) << packRate << setw(16) << unpackRate << endl;
+    }
+    cout << "Checksum: " << checksum << endl;
+    return 0;
+}
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "position.h"
+#include "movegen.h"
+#include "gameStatus.h"
+
+using namespace std;
+
+struct BenchPosition {
+    string name;
+    string fen;
+};
+
+// Standard mate detection test positions
+static const vector<BenchPosition> positions = {
+    {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+    {"fools mate", "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3"},
+    {"scholars mate", "r1bqkb1r/pppp1Qpp/2n2n2/4p3/2B1P3/8/PPPP1PPP/RNB1K1NR b KQkq - 0 4"},
+    {"back rank mate", "3R2k1/5ppp/8/8/8/8/5PPP/6K1 b - - 1 1"},
+    {"smothered mate", "6rk/5Npp/8/8/8/8/6PP/6K1 b - - 1 1"},
+    {"stalemate", "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+};
+
+/**
+ * @brief How a position stands once the side to move's legal moves are known.
+ */
+enum Outcome {
+    ONGOING,
+    CHECKMATE,
+    STALEMATE
+};
+
+/**
+ * @class MailboxBoard
+ * @brief The game's board before the rules moved to bitboards, kept as the baseline the detectors are timed against.
+ *
+ * Like the old ChessBoard, it holds a piece per square with its type and player as strings, and finds mate the way
+ * checkMated did: every source and destination square pair is tried with testMove, which checks the piece's movement
+ * rule, plays the move and asks every enemy piece whether it can move onto the king. As there, pawns neither capture
+ * en passant nor promote and castling is left out; none of them is legal out of check or decides the positions here.
+ */
+class MailboxBoard {
+public:
+    explicit MailboxBoard(const Position& pos) {
+        static const char* typeNames[] = {"pawn", "knight", "bishop", "rook", "queen", "king"};
+        pieces.reserve(32);
+        for (int square = 0; square < 64; ++square) {
+            board[square / 8][square % 8] = nullptr;
+            if (!pos.empty(square)) {
+                pieces.push_back({typeNames[pos.typeOn(square)], pos.colorOn(square) == WHITE ? "white" : "black"});
+                board[square / 8][square % 8] = &pieces.back();
+            }
+        }
+        player = pos.sideToMove() == WHITE ? "white" : "black";
+    }
+
+    /**
+     * @brief Finds checkmate and stalemate for the side to move.
+     */
+    Outcome outcome() {
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                if (board[i][j] != nullptr && board[i][j]->player == player) {
+                    for (int k = 0; k < 8; ++k) {
+                        for (int l = 0; l < 8; ++l) {
+                            string move = squareText(i, j) + squareText(k, l);
+                            if (testMove(move)) {
+                                return ONGOING;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return inCheck(player) ? CHECKMATE : STALEMATE;
+    }
+
+private:
+    /**
+     * @struct Piece
+     * @brief A piece as the old ChessPiece described it.
+     */
+    struct Piece {
+        string type; // "pawn", "knight", "bishop", "rook", "queen" or "king"
+        string player; // "white" or "black"
+    };
+
+    vector<Piece> pieces; // The pieces on the board
+    Piece* board[8][8]; // Piece on each square by row and column, row 0 is rank 1, nullptr if empty
+    string player; // The side to move
+
+    static string squareText(int row, int col) { return string(1, 'a' + col) + to_string(row + 1); }
+
+    bool inCheck(const string& player) {
+        int kingRow = -1;
+        int kingCol = -1;
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                if (board[i][j] != nullptr && board[i][j]->type == "king" && board[i][j]->player == player) {
+                    kingRow = i;
+                    kingCol = j;
+                }
+            }
+        }
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                if (board[i][j] != nullptr && board[i][j]->player != player
+                    && validMove(squareText(i, j) + squareText(kingRow, kingCol))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool testMove(const string& move) {
+        if (!validMove(move)) {
+            return false;
+        }
+        Piece*& from = board[move[1] - '1'][move[0] - 'a'];
+        Piece*& to = board[move[3] - '1'][move[2] - 'a'];
+        Piece* piece = from;
+        Piece* captured = to;
+        to = piece;
+        from = nullptr;
+        bool check = inCheck(piece->player);
+        from = piece;
+        to = captured;
+        return !check;
+    }
+
+    bool validMove(const string& move) {
+        int fromCol = move[0] - 'a';
+        int fromRow = move[1] - '1';
+        int toCol = move[2] - 'a';
+        int toRow = move[3] - '1';
+        Piece* piece = board[fromRow][fromCol];
+        if (piece == nullptr || (fromRow == toRow && fromCol == toCol)) {
+            return false;
+        }
+        if (board[toRow][toCol] != nullptr && board[toRow][toCol]->player == piece->player) {
+            return false;
+        }
+        int rows = abs(toRow - fromRow);
+        int cols = abs(toCol - fromCol);
+        if (piece->type == "pawn") {
+            int direction = (piece->player == "white") ? 1 : -1;
+            int startRow = (piece->player == "white") ? 1 : 6;
+            if (fromCol == toCol && board[toRow][toCol] == nullptr) {
+                return toRow == fromRow + direction
+                       || (fromRow == startRow && toRow == fromRow + 2 * direction && board[fromRow + direction][toCol] == nullptr);
+            }
+            return cols == 1 && toRow == fromRow + direction && board[toRow][toCol] != nullptr;
+        } else if (piece->type == "knight") {
+            return (rows == 2 && cols == 1) || (rows == 1 && cols == 2);
+        } else if (piece->type == "bishop") {
+            return rows == cols && pathClear(fromRow, fromCol, toRow, toCol);
+        } else if (piece->type == "rook") {
+            return (rows == 0 || cols == 0) && pathClear(fromRow, fromCol, toRow, toCol);
+        } else if (piece->type == "queen") {
+            return (rows == cols || rows == 0 || cols == 0) && pathClear(fromRow, fromCol, toRow, toCol);
+        } else if (piece->type == "king") {
+            return rows <= 1 && cols <= 1;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Returns whether the squares between two squares on a line are empty.
+     */
+    bool pathClear(int fromRow, int fromCol, int toRow, int toCol) {
+        int rowDirection = (toRow > fromRow) ? 1 : (toRow < fromRow) ? -1 : 0;
+        int colDirection = (toCol > fromCol) ? 1 : (toCol < fromCol) ? -1 : 0;
+        for (int row = fromRow + rowDirection, col = fromCol + colDirection; row != toRow || col != toCol;
+             row += rowDirection, col += colDirection) {
+            if (board[row][col] != nullptr) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Finds checkmate and stalemate by asking Position::isLegal about every source and destination square pair.
+ */
+static Outcome outcomeByProbing(const Position& pos) {
+    Bitboard own = pos.pieces(pos.sideToMove());
+    while (own) {
+        int from = popLsb(own);
+        for (int to = 0; to < 64; ++to) {
+            if (pos.isLegal(from, to)) return ONGOING;
+        }
+    }
+    return pos.inCheck(pos.sideToMove()) ? CHECKMATE : STALEMATE;
+}
+
+/**
+ * @brief Finds checkmate and stalemate with the full game status, built on the legal move generator.
+ */
+static Outcome outcomeByGameStatus(const Position& pos) {
+    GameStatus status = computeGameStatus(pos);
+    if (status.checkmate) return CHECKMATE;
+    return status.stalemate() ? STALEMATE : ONGOING;
+}
+
+/**
+ * @brief Returns the average time of a detection call in microseconds.
+ */
+template <typename Detector>
+static double timeDetector(const Position& pos, Detector detector, int iterations, Outcome& result) {
+    auto start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        result = detector(pos);
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double, micro>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = (argc > 1) ? stoi(argv[1]) : 2000;
+    initBitboards();
+
+    // Times are per detection call; the speedup is the mailbox baseline's time over the game status'
+    const char* outcomeNames[] = {"ongoing", "mate", "stalemate"};
+    cout << left << setw(16) << "position" << right << setw(10) << "outcome" << setw(14) << "mailbox (us)"
+         << setw(14) << "probe (us)" << setw(14) << "status (us)" << setw(10) << "speedup" << endl;
+
+    for (const BenchPosition& bench : positions) {
+        Position pos;
+        if (!pos.set(bench.fen)) {
+            cerr << "Invalid FEN for " << bench.name << endl;
+            return 1;
+        }
+
+        MailboxBoard mailbox(pos);
+        Outcome mailboxResult = ONGOING;
+        Outcome probeResult = ONGOING;
+        Outcome statusResult = ONGOING;
+        double mailboxTime = timeDetector(pos, [&](const Position&) { return mailbox.outcome(); }, iterations, mailboxResult);
+        double probeTime = timeDetector(pos, outcomeByProbing, iterations, probeResult);
+        double generatorTime = timeDetector(pos, outcomeByGameStatus, iterations, statusResult);
+        if (mailboxResult != statusResult || probeResult != statusResult) {
+            cerr << "Outcome mismatch for " << bench.name << endl;
+            return 1;
+        }
+
+        cout << left << setw(16) << bench.name << right << setw(10) << outcomeNames[statusResult]
+             << fixed << setprecision(3) << setw(14) << mailboxTime << setw(14) << probeTime << setw(14) << generatorTime
+             << setprecision(1) << setw(9) << mailboxTime / generatorTime << "x" << endl;
+    }
+    return 0;
+}
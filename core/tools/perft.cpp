@@ -0,0 +1,253 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <cctype>
+#include "position.h"
+#include "movegen.h"
+
+using namespace std;
+
+/**
+ * @class PerftTable
+ * @brief Shared lockless table of subtree node counts, keyed by position key and depth.
+ */
+class PerftTable {
+public:
+    /**
+     * @brief Allocates the table.
+     * @param megabytes The size of the table, rounded down to a power of two entry count.
+     */
+    explicit PerftTable(size_t megabytes) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Entry) <= megabytes * 1024 * 1024) {
+            count *= 2;
+        }
+        entries.reset(new Entry[count]);
+        mask = count - 1;
+    }
+
+    /**
+     * @brief Looks up the node count of a position at a depth.
+     * @return True if the count was found, false otherwise.
+     */
+    bool probe(Key key, int depth, uint64_t& nodes) const {
+        Key k = salted(key, depth);
+        const Entry& e = entries[k & mask];
+        uint64_t n = e.nodes.load(memory_order_relaxed);
+        if ((e.check.load(memory_order_relaxed) ^ n) != k) {
+            return false;
+        }
+        nodes = n;
+        return true;
+    }
+
+    /**
+     * @brief Stores the node count of a position at a depth, replacing whatever was in its slot.
+     */
+    void store(Key key, int depth, uint64_t nodes) {
+        Key k = salted(key, depth);
+        Entry& e = entries[k & mask];
+        e.nodes.store(nodes, memory_order_relaxed);
+        e.check.store(k ^ nodes, memory_order_relaxed);
+    }
+
+private:
+    /**
+     * A torn write from another thread leaves check ^ nodes pointing at a different key,
+     * so entries need no locks
+     */
+    struct Entry {
+        atomic<uint64_t> check{0}; // Salted key xor node count
+        atomic<uint64_t> nodes{0}; // Node count of the subtree
+    };
+
+    unique_ptr<Entry[]> entries;
+    size_t mask;
+
+    static Key salted(Key key, int depth) { return key ^ (0x9E3779B97F4A7C15ULL * (depth + 1)); }
+};
+
+/**
+ * @brief Counts the leaf nodes of the legal move tree of a position.
+ */
+static uint64_t perft(const Position& pos, int depth, PerftTable* table) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    MoveList list;
+    generateLegalMoves(pos, list);
+    if (depth == 1) {
+        return list.size();
+    }
+
+    uint64_t nodes = 0;
+    if (table && table->probe(pos.key(), depth, nodes)) {
+        return nodes;
+    }
+    for (const Move& move : list) {
+        Position next = pos;
+        next.applyMove(move);
+        nodes += perft(next, depth - 1, table);
+    }
+    if (table) {
+        table->store(pos.key(), depth, nodes);
+    }
+    return nodes;
+}
+
+/**
+ * @brief Runs perft with the root moves split over a pool of threads.
+ * @param pos The root position.
+ * @param depth The depth to search.
+ * @param threads The number of worker threads.
+ * @param table The shared table, or nullptr to count every node.
+ * @param divide Whether to print the node count of every root move.
+ * @return The total node count.
+ */
+static uint64_t parallelPerft(const Position& pos, int depth, int threads, PerftTable* table, bool divide) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    MoveList list;
+    generateLegalMoves(pos, list);
+    vector<uint64_t> counts(list.size(), 0);
+
+    // Workers take the next unclaimed root move until none are left
+    atomic<int> next(0);
+    auto worker = [&]() {
+        int i;
+        while ((i = next.fetch_add(1)) < list.size()) {
+            Position child = pos;
+            child.applyMove(list.moves[i]);
+            counts[i] = perft(child, depth - 1, table);
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (thread& t : pool) {
+        t.join();
+    }
+
+    uint64_t total = 0;
+    vector<pair<string, uint64_t>> rootCounts;
+    for (int i = 0; i < list.size(); ++i) {
+        total += counts[i];
+        rootCounts.push_back({list.moves[i].toString(), counts[i]});
+    }
+    if (divide) {
+        sort(rootCounts.begin(), rootCounts.end());
+        for (const auto& entry : rootCounts) {
+            cout << entry.first << ": " << entry.second << endl;
+        }
+        cout << endl;
+    }
+    return total;
+}
+
+struct ReferencePosition {
+    string name;
+    string fen;
+    int depth;
+    uint64_t nodes;
+};
+
+// Standard perft test positions with their published node counts
+static const vector<ReferencePosition> references = {
+    {"start", START_FEN, 5, 4865609},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+    {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+    {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+    {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+};
+
+static void printUsage() {
+    cerr << "Usage: chess_perft <depth> [fen] [divide] [-t threads] [-H hashMB]" << endl
+         << "       chess_perft bench [-t threads] [-H hashMB]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int depth = -1;
+    string fen = START_FEN;
+    bool divide = false;
+    bool bench = false;
+    int threads = max(1u, thread::hardware_concurrency());
+    size_t hashMB = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "divide") {
+            divide = true;
+        } else if (arg == "bench") {
+            bench = true;
+        } else if (arg == "-t" && i + 1 < argc) {
+            threads = max(1, stoi(argv[++i]));
+        } else if (arg == "-H" && i + 1 < argc) {
+            hashMB = stoul(argv[++i]);
+        } else if (depth < 0 && !arg.empty() && all_of(arg.begin(), arg.end(), ::isdigit)) {
+            depth = stoi(arg);
+        } else {
+            fen = arg;
+        }
+    }
+    if (!bench && depth < 0) {
+        printUsage();
+        return 1;
+    }
+
+    initBitboards();
+    unique_ptr<PerftTable> table;
+    if (hashMB > 0) {
+        table.reset(new PerftTable(hashMB));
+    }
+
+    vector<ReferencePosition> runs;
+    if (bench) {
+        runs = references;
+    } else {
+        runs.push_back({"", fen, depth, 0});
+    }
+
+    bool allPassed = true;
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+    for (const ReferencePosition& run : runs) {
+        Position pos;
+        if (!pos.set(run.fen)) {
+            cerr << "Invalid FEN: " << run.fen << endl;
+            return 1;
+        }
+
+        auto start = chrono::high_resolution_clock::now();
+        uint64_t nodes = parallelPerft(pos, run.depth, threads, table.get(), divide);
+        double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        totalNodes += nodes;
+        totalSeconds += seconds;
+
+        if (bench) {
+            bool passed = nodes == run.nodes;
+            allPassed = allPassed && passed;
+            cout << left << setw(12) << run.name << right << " depth " << run.depth << setw(12) << nodes
+                 << (passed ? "  ok  " : "  FAIL") << fixed << setprecision(3) << setw(9) << seconds << " s" << endl;
+        } else {
+            cout << "Nodes: " << nodes << endl;
+        }
+    }
+
+    cout << "Time: " << fixed << setprecision(3) << totalSeconds << " s, " << threads << " threads"
+         << (table ? ", hash " + to_string(hashMB) + " MB" : "") << endl;
+    cout << "Speed: " << fixed << setprecision(0) << totalNodes / max(totalSeconds, 1e-9) << " nodes/s" << endl;
+    return allPassed ? 0 : 1;
+}
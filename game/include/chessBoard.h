@@ -5,12 +5,19 @@
 #include "chessPiece.h"
 #include "graphics.h"
 #include "fen.h"
+#include "position.h"
+#include "movegen.h"
+#include "attackMap.h"
+#include "gameStatus.h"
 #include "chessEngine.h"
 #include "sound.h"
 #include "multiplayer.h"
 
 using namespace std;
 
+const int BOARD_TEXTURE_SIZE = 512; // Width and height of the checkerboard texture in pixels
+const double OPPONENT_MIN_DELAY = 1.0; // Seconds the opponent takes at least, so its move can be followed
+
 /**
  * @class ChessBoard
  * @brief Implements all functionalities of a chessboard.
@@ -28,6 +35,18 @@ public:
      */
     ChessBoard(glm::vec3 position);
 
+    /**
+     * @brief The board owns GL objects and its pieces, so it is neither copied nor assigned.
+     */
+    ChessBoard(const ChessBoard&) = delete;
+    ChessBoard& operator=(const ChessBoard&) = delete;
+
+    /**
+     * @brief Places the pieces and creates the board's GL objects. Needs a GL context and the rules tables.
+     * @param position The position of the chessboard.
+     */
+    void init(glm::vec3 position);
+
     /**
      * @brief Prints the current state of the chessboard.
      */
@@ -78,28 +97,17 @@ public:
      */
     bool getGameRunning() { return gameRunning; }
 
-    /**
-     * @brief Returns the FEN string of the chessboard.
-     * @return The FEN string.
-     */
-    string getFEN() const { return FEN; }
-
-    /**
-     * @brief Sets the FEN string of the chessboard.
-     * @param fen The FEN string.
-     */
-    void setFEN(const string& fen) { FEN = fen; }
-
     /**
      * @brief Moves a piece on the chessboard.
      * @param move The move to make.
      */
-    void movePiece(const string& move, bool sendMoveToMultiplayerOpponent=true);
+    void movePiece(Move move, bool sendMoveToMultiplayerOpponent=true);
 
     /**
-     * @brief Gets the move from the opponent (Stockfish).
+     * @brief Plays the opponent's move once it arrived from the engine or the multiplayer opponent
+     * and the opponent has taken at least OPPONENT_MIN_DELAY. Does not block.
      */
-    void getOpponentMove();
+    void pollOpponentMove();
 
     /**
      * @brief Generates the mesh for the chessboard.
@@ -116,39 +124,109 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Takes back the last move. Against the engine the engine's reply is taken back too,
+     * so it is the player's turn again. Not available in multiplayer games.
+     */
+    void takeBack();
+
     /**
      * @brief Checks if a player is in check.
      * @param player The player to check.
      * @return True if the player is in check, false otherwise.
      */
-    bool inCheck(const string& player);
+    bool inCheck(Color player);
 
     /**
      * @brief Checks if a player is checkmated.
      * @param player The player to check.
      * @return True if the player is checkmated, false otherwise.
      */
-    bool checkMated(const string& player);
+    bool checkMated(Color player);
+
+    /**
+     * @brief Checks if a player is stalemated.
+     * @param player The player to check.
+     * @return True if the player has no legal moves and is not in check, false otherwise.
+     */
+    bool staleMated(Color player);
+
+    /**
+     * @brief Returns the status of the current position, computed once per move.
+     * @return The game status.
+     */
+    const GameStatus& getStatus() const { return status; }
+
+    /**
+     * @brief Returns the Zobrist key of the current position, e.g. to key caches or detect desyncs.
+     * @return The position key.
+     */
+    Key getPositionKey() const { return position.key(); }
+
+    /**
+     * @brief Returns a copy of the current position. Take it on the thread that moves pieces,
+     * then hand the copy to other threads instead of letting them read the live board.
+     * @return The position.
+     */
+    Position getPositionSnapshot() const { return position; }
+
+    /**
+     * @brief Returns the moves of the current game in the order they were played from the starting position.
+     * @return The moves.
+     */
+    vector<Move> getMoveHistory() const;
+
+    /**
+     * @brief Returns the keys of all positions of the current game by ply.
+     * @return The key history, ending with the current position.
+     */
+    const vector<Key>& getKeyHistory() const { return keyHistory; }
+
+    /**
+     * @brief Returns the legal moves of the piece on a square.
+     * @param square The square of the piece.
+     * @return The legal moves, promotions listed once as queen promotions.
+     */
+    vector<Move> getLegalMoves(int square);
 
 private:
+    /**
+     * @struct BoardUndo
+     * @brief Everything needed to take back a move on the position and the rendered pieces.
+     */
+    struct BoardUndo {
+        Move move; // The move that was made
+        UndoInfo state; // Position state the move overwrote
+        ChessPiece* captured; // Rendered piece the move captured, or nullptr
+        bool pieceHadMoved; // hasMoved flag of the moving piece before the move
+        bool rookHadMoved; // hasMoved flag of the castling rook before the move
+    };
+
     GLuint boardVAO; // Vertex array object for the chessboard
     GLuint boardTexture; // Texture for the chessboard
-    ChessPiece* board[8][8]; // Backing array to store pointers to chess pieces
+    ChessPiece* board[8][8]; // Rendered pieces by square, mirrors position
+    Position position; // Bitboard position used for all rule decisions
+    AttackMap attackMap; // Squares attacked by each side in position, updated with every move
+    GameStatus status; // Check, mate and draw state of position, updated with every move
+    vector<Key> keyHistory; // Position keys of the game indexed by ply, for repetition detection
+    vector<BoardUndo> undoStack; // Moves made this game, most recent last
     vector<ChessPiece*> pieces; // List of chess pieces for rendering
     glm::vec3 boardPosition; // Position of the board in 3D space
     glm::mat4 modelMatrix; // Model matrix for the board
     string hoveredPieceLocation; // Location of the piece currently hovered over
     string selectedPieceLocation; // Location of the piece currently selected
+    MoveList selectedMoves; // Legal moves of the selected piece, promotions listed once as queen promotions
+    int selectedMovesSquare; // Square selectedMoves was generated for, or NO_SQUARE
+    Key selectedMovesKey; // Position key selectedMoves was generated for
+    Bitboard highlightedSquares; // Squares currently highlighted in the board texture
     string targetPointerLocation; // Location of the square at the center of the screen
-    string playerTurn; // The current player's turn
+    Color playerTurn; // The current player's turn
     bool opponentProcessing; // Flag to indicate if the opponent is processing a move
-    string FEN; // FEN string of the chessboard
     double checkMatedTime; // Time when the checkmate occurred
-    bool whiteInCheck; // Flag to indicate if white is in check
-    bool blackInCheck; // Flag to indicate if black is in check
     bool overrideMode; // Flag to override the player's turn
-    string opponentMove; // The move received from the opponent
-    bool opponentMoveReceived; // Flag to indicate if the opponent's move has been received
+    Move opponentMove; // The move received from the multiplayer opponent, not played yet
+    MoveRequest opponentRequest; // The engine search for the opponent's move
+    double opponentRequestTime; // Time the opponent's move was asked for
     bool gameRunning; // Flag to indicate if the game is running
     bool animating; // Flag to indicate if a piece is being animated
     vector<ChessPiece*> takenWhitePieces; // List of white pieces taken
@@ -157,77 +235,62 @@ private:
     vector<ChessPiece*> sortTakenPieces(vector<ChessPiece*>& pieces);
 
     /**
-     * @brief Checks if a square is under attack by a player.
-     * @param square The square to check.
-     * @param player The player to check.
-     * @return True if the square is under attack, false otherwise.
+     * @brief Checks if a move is legal in the current position.
+     * @param move The move to check.
+     * @param errorsOff Whether to suppress error messages and the turn check.
+     * @return True if the move is valid, false otherwise.
      */
-    pair<int, int> getPositionFromNotation(const string& notation);
+    bool validMove(Move move, bool errorsOff=false);
 
     /**
-     * @brief Checks if a square is under attack by a player.
-     * @param square The square to check.
-     * @param player The player to check.
-     * @return True if the square is under attack, false otherwise.
+     * @brief Regenerates the legal moves of the selected piece if the selection or the position changed,
+     * and highlights their destination squares.
      */
-    bool validMove(const string& move, bool errorsOff=false, bool checkCastling=true);
+    void updateSelection();
 
     /**
-     * @brief Checks if a move is valid.
+     * @brief Checks if a move is one of the cached legal moves of the selected piece in the current position.
      * @param move The move to check.
-     * @return True if the move is valid, false otherwise.
-     */
-    bool testMove(const string& move);
-
-    /**
-     * @brief Checks if a square is under attack by a player.
-     * @param square The square to check.
-     * @param player The player to check.
-     * @return True if the square is under attack, false otherwise.
+     * @return True if the move is known to be legal, false otherwise.
      */
-    bool squareUnderAttackBy(string square, string player);
+    bool isSelectedMove(Move move) const;
 
     /**
-     * @brief Checks if a player is in check.
-     * @param player The player to check.
-     * @return True if the player is in check, false otherwise.
+     * @brief Redraws the squares of the board texture whose highlighting changed.
+     * @param squares The squares to highlight.
      */
-    bool isValidRookMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff=false);
+    void highlightSquares(Bitboard squares);
 
     /**
-     * @brief Checks if a player is in check.
+     * @brief Checks if a square is under attack by a player.
+     * @param square The square to check.
      * @param player The player to check.
-     * @return True if the player is in check, false otherwise.
+     * @return True if the square is under attack, false otherwise.
      */
-    bool isValidKnightMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff=false);
+    bool squareUnderAttackBy(int square, Color player);
 
     /**
-     * @brief Checks if a player is in check.
-     * @param player The player to check.
-     * @return True if the player is in check, false otherwise.
+     * @brief Recomputes the game status after the position changed.
      */
-    bool isValidBishopMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff=false);
+    void updateStatus();
 
     /**
-     * @brief Checks if a player is in check.
-     * @param player The player to check.
-     * @return True if the player is in check, false otherwise.
+     * @brief Places all pieces of both sides on their starting squares.
      */
-    bool isValidQueenMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff=false);
+    void setupPieces();
 
     /**
-     * @brief Checks if a player is in check.
-     * @param player The player to check.
-     * @return True if the player is in check, false otherwise.
+     * @brief Takes back the most recent move on the undo stack.
      */
-    bool isValidKingMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff=false, bool checkCastling=true);
+    void undoLastMove();
 
     /**
-     * @brief Checks if a player is in check.
-     * @param player The player to check.
-     * @return True if the player is in check, false otherwise.
+     * @brief Moves a rendered piece to a new square and animates the move.
+     * @param piece The piece to move.
+     * @param src The (column, row) the piece moves from.
+     * @param dst The (column, row) the piece moves to.
      */
-    bool isValidPawnMove(int fromRow, int fromCol, int toRow, int toCol, ChessPiece* piece, bool errorsOff=false);
+    void animatePiece(ChessPiece* piece, pair<int, int> src, pair<int, int> dst);
 };
 
 #endif
\ No newline at end of file
@@ -2,9 +2,75 @@
 #define CHESS_ENGINE_H
 
 #include "globals.h"
+#include "movegen.h"
+#include "enginePool.h"
+#include "uci.h"
+#include <future>
+#include <condition_variable>
 
 using namespace std;
 
+const int ENGINE_POOL_SIZE = 1; // Stockfish processes started for the game
+const int ENGINE_POLL_MS = 10; // How often a running search checks whether it was cancelled
+
+/**
+ * @struct MoveRequestState
+ * @brief State of one move request, shared between its handle and the engine worker.
+ */
+struct MoveRequestState {
+    uint64_t generation; // Number of the request, increasing with every request made
+    Position start; // Position the game started from
+    vector<Move> moves; // Moves of the game played from start
+    Position position; // Position to search, start with moves played
+    SearchLimits limits; // Bounds of the search
+    promise<Move> result; // Set by the worker, MOVE_NONE if the request was cancelled or superseded
+    atomic<bool> cancelled{false}; // Set by cancel, checked by the worker while it searches
+};
+
+/**
+ * @class MoveRequest
+ * @brief Handle to a move being searched by the engine. Copies refer to the same request.
+ */
+class MoveRequest {
+public:
+    MoveRequest() = default;
+    MoveRequest(shared_ptr<MoveRequestState> state) : state(state), result(state->result.get_future().share()) {}
+
+    /**
+     * @brief Returns whether the handle refers to a request.
+     */
+    bool valid() const { return state != nullptr; }
+
+    /**
+     * @brief Returns the generation of the request, 0 for an empty handle.
+     */
+    uint64_t generation() const { return state ? state->generation : 0; }
+
+    /**
+     * @brief Returns whether the result is available, without blocking.
+     */
+    bool ready() const { return state && result.wait_for(chrono::seconds(0)) == future_status::ready; }
+
+    /**
+     * @brief Waits for the result.
+     * @return The best move, or MOVE_NONE if the engine has none or the request was cancelled.
+     */
+    Move get() const { return state && !state->cancelled ? result.get() : MOVE_NONE; }
+
+    /**
+     * @brief Cancels the request. A running search is stopped and its result discarded.
+     */
+    void cancel() {
+        if (state) {
+            state->cancelled = true;
+        }
+    }
+
+private:
+    shared_ptr<MoveRequestState> state; // Shared with the engine worker
+    shared_future<Move> result; // Result of the request
+};
+
 /**
  * @class Stockfish
  * @brief Represents the Stockfish chess engine.
@@ -14,7 +80,7 @@ public:
     /**
      * @brief Default constructor.
      */
-    Stockfish(bool remote=false) : depth(0), stockfishProcess(nullptr), remoteProcessing(remote) {};
+    Stockfish(bool remote=false);
 
     /**
      * @brief Destructor.
@@ -22,9 +88,10 @@ public:
     ~Stockfish();
 
     /**
-     * @brief Initializes the Stockfish engine.
+     * @brief Sets the engine pool local searches run on.
+     * @param pool The pool, which must outlive this object.
      */
-    void init();
+    void init(EnginePool& pool);
 
     /**
      * @brief Sets the depth of the Stockfish engine.
@@ -33,7 +100,7 @@ public:
     void setDepth(int depth) { this->depth = depth; }
 
     /**
-     * @brief Sets the difficulty of the Stockfish engine.
+     * @brief Sets the difficulty of the Stockfish engine. The option is sent before the next search.
      * @param difficulty The difficulty to set.
      */
     void setDifficulty(int difficulty);
@@ -45,18 +112,47 @@ public:
     void setRemoteProcessing(bool remote) { remoteProcessing = remote; }
 
     /**
-     * @brief Gets the best move for a given board position.
+     * @brief Sets whether the engine keeps searching on the reply it expects while the player thinks.
+     * @param enabled Whether to ponder.
+     */
+    void setPondering(bool enabled) { ponderEnabled = enabled; }
+
+    /**
+     * @brief Returns the share of the pool's ponder searches whose expected reply was played.
+     * @return The ponder hit rate between 0 and 1, 0 before any ponder search was resolved.
+     */
+    double getPonderHitRate() const;
+
+    /**
+     * @brief Queues a search on the engine's worker thread. A newer request supersedes older ones,
+     * whose results are discarded.
      * @param boardPosition The board position to get the best move for.
-     * @return The best move.
+     * @param limits The bounds of the search, the engine's depth if they set none.
+     * @return A handle to poll, wait on or cancel.
+     */
+    MoveRequest requestMove(const Position& boardPosition, SearchLimits limits = {}) { return requestMove(boardPosition, {}, limits); }
+
+    /**
+     * @brief Queues a search for the position a game reached. The engine is told the moves rather than
+     * the position, so it knows the game's history and keeps its hash table from move to move.
+     * @param start The position the game started from.
+     * @param moves The moves of the game played from start.
+     * @param limits The bounds of the search, the engine's depth if they set none.
+     * @return A handle to poll, wait on or cancel.
      */
-    string getMove(const string& boardPosition);
+    MoveRequest requestMove(const Position& start, const vector<Move>& moves, SearchLimits limits = {});
 
     /**
-     * @brief Gets the best move for a given board position using local processing.
+     * @brief Tells the engine a new game starts. Running searches are stopped and their results discarded.
+     */
+    void newGame();
+
+    /**
+     * @brief Gets the best move for a given board position, waiting for the search.
      * @param boardPosition The board position to get the best move for.
-     * @return The best move.
+     * @return The best move, or MOVE_NONE if the engine has none.
      */
-    string getMoveLocal(const string& boardPosition);
+    Move getMove(const Position& boardPosition) { return requestMove(boardPosition).get(); }
 
     /**
      * @brief Gets the best move for a given board position using remote processing.
@@ -68,10 +164,22 @@ public:
 private:
     bool remoteProcessing; // Whether to process moves remotely
     int depth; // The depth of the Stockfish engine
-    int difficulty; // The difficulty of the Stockfish engine
-    FILE* stockfishProcess; // The Stockfish process
-    void sendCommand(const string& command); // Sends a command to the Stockfish engine
-    string readResponse(); // Reads the response from the Stockfish engine
+    int difficulty; // The difficulty of the Stockfish engine, guarded by requestMutex
+    EnginePool* pool; // Runs the local searches, nullptr before init
+    int client; // Client ID of this engine's jobs in the pool
+    thread worker; // Runs the searches one at a time
+    mutex requestMutex; // Guards pendingRequest, worker, stopping and newGamePending
+    condition_variable requestReady; // Wakes the worker for a new request or to stop
+    shared_ptr<MoveRequestState> pendingRequest; // Request waiting for the worker
+    atomic<uint64_t> latestGeneration; // Generation of the newest request, older ones are stale
+    bool stopping; // Tells the worker to exit
+    bool newGamePending; // Tells the pool to send ucinewgame before the next search
+    atomic<bool> ponderEnabled; // Whether to ponder after each engine move
+    void workerLoop(); // Takes requests and searches them until stopping
+    Move search(const MoveRequestState& request, bool newGame, int skill); // Searches one request locally or remotely
+    Move getMoveLocal(const MoveRequestState& request, bool newGame, int skill); // Searches on the engine pool
+    bool isStale(const MoveRequestState& request) const; // Whether a request was cancelled or superseded
+    SearchLimits searchLimits(SearchLimits limits) const; // Returns the limits of a search, the engine's depth if they set none
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, string* output); // Callback function for writing response
     string sendGetRequest(const string& url); // Sends a GET request to an API
     string parseMove(const string& response); // Parses the best move from the response
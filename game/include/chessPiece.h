@@ -3,6 +3,7 @@
 
 #include "globals.h"
 #include "graphics.h"
+#include "bitboard.h"
 
 using namespace std;
 
@@ -25,13 +26,13 @@ public:
      * @param type The type of the piece.
      * @param player The player that owns the piece.
      */
-    ChessPiece(float x, float y, float z, string type, string player);
+    ChessPiece(float x, float y, float z, PieceType type, Color player);
 
     /**
      * @brief Converts the piece to a new type.
      * @param newType The new type to convert to.
      */
-    void convertTo(const std::string& newType);
+    void convertTo(PieceType newType);
 
     /**
      * @brief Sets the position of the chess piece.
@@ -74,13 +75,13 @@ public:
      * @brief Returns the player that owns the piece.
      * @return The player that owns the piece.
      */
-    string getPlayer() const { return player; }
+    Color getPlayer() const { return player; }
 
     /**
      * @brief Returns the type of the piece.
      * @return The type of the piece.
      */
-    string getType() const { return type; }
+    PieceType getType() const { return type; }
 
     /**
      * @brief Loads the mesh for the chess piece.
@@ -123,8 +124,8 @@ public:
     static GLuint darkGreyTexture; // Texture for dark grey pieces
 
 private:
-    string type; // Type of the piece
-    string player; // Player that owns the piece
+    PieceType type; // Type of the piece
+    Color player; // Player that owns the piece
     bool hovered; // Whether the piece is hovered over
     GLuint pieceVAO; // Vertex array object for the piece
     GLuint pieceTexture; // Texture for the piece
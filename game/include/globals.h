@@ -29,6 +29,7 @@
 #include <nlohmann/json.hpp>
 #include <SFML/Audio.hpp>
 #include "camera.h"
+#include "types.h"
 #include "config.h"
 
 using namespace std;
@@ -38,8 +39,9 @@ extern float HEIGHT;
 extern GLFWwindow* window;
 extern bool remote;
 extern atomic<bool> multiplayer;
-extern string playerColor;
+extern Color playerColor;
 extern atomic<bool> resetBoard;
+extern atomic<bool> moveRejected;
 
 extern GLuint frameBuffer;
 extern GLuint frameVAO;
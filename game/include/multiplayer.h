@@ -2,18 +2,21 @@
 #define MULTIPLAYER_H
 
 #include "globals.h"
+#include "move.h"
 
 using namespace std;
 
 /**
  * @brief Looks for an opponent to play against.
+ * @return The color assigned by the server, white if no game could be joined.
  */
-string lookForOpponent();
+Color lookForOpponent();
 
 /**
- * @brief Get the opponent's current move.
+ * @brief Takes the opponent's latest move without waiting for one.
+ * @return The move, or MOVE_NONE if none arrived yet.
  */
-string getMultiplayerMove();
+Move getMultiplayerMove();
 
 /**
  * @brief Constantly listen for the opponent's move.
@@ -21,10 +24,15 @@ string getMultiplayerMove();
 void listenForMultiplayerMove();
 
 /**
- * @brief Sends a move to the opponent.
+ * @brief Sends a move to the opponent as its packed 16-bit value.
  * @param move The move to send.
  */
-void sendMove(const string& move);
+void sendMove(Move move);
+
+/**
+ * @brief Asks the opponent to reset the board.
+ */
+void sendReset();
 
 /**
  * @brief Cleans up the multiplayer game.
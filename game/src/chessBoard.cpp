@@ -4,9 +4,10 @@ using namespace std;
 
 ChessBoard::ChessBoard()
     : boardVAO(0), boardTexture(0), boardPosition(glm::vec3(0.0f, 0.0f, 0.0f)), hoveredPieceLocation(""),
-    selectedPieceLocation(""), targetPointerLocation(""), playerTurn("white"),
-    FEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"), opponentProcessing(false),
-    checkMatedTime(0), whiteInCheck(false), blackInCheck(false), opponentMove(""), opponentMoveReceived(false),
+    selectedPieceLocation(""), selectedMovesSquare(NO_SQUARE), selectedMovesKey(0), highlightedSquares(0),
+    targetPointerLocation(""), playerTurn(WHITE),
+    opponentProcessing(false),
+    checkMatedTime(0), opponentMove(MOVE_NONE), opponentRequestTime(0),
     gameRunning(false), animating(false), overrideMode(false) {
 
     for (int i = 0; i < 8; ++i) {
@@ -14,6 +15,8 @@ ChessBoard::ChessBoard()
             board[i][j] = nullptr;
         }
     }
+    // Attack tables are not set up yet when the global board is constructed, so only the pieces are placed here
+    position.set(START_FEN);
 }
 
 void ChessBoard::printBoard() {
@@ -25,7 +28,7 @@ void ChessBoard::printBoard() {
             if (board[i][j] == nullptr) {
                 cout << " ";
             } else {
-                cout << board[i][j]->getType()[0];
+                cout << pieceTypeName(board[i][j]->getType())[0];
             }
             cout << "|";
         }
@@ -34,49 +37,50 @@ void ChessBoard::printBoard() {
     }
 }
 
-ChessBoard::ChessBoard(glm::vec3 position)
-    : boardVAO(0), boardTexture(0), boardPosition(position), hoveredPieceLocation(""),
-    selectedPieceLocation(""), targetPointerLocation(""), playerTurn("white"),
-    FEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"), opponentProcessing(false),
-    checkMatedTime(0), whiteInCheck(false), blackInCheck(false), opponentMove(""), opponentMoveReceived(false),
-    gameRunning(false), animating(false), overrideMode(false) {
-    
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            board[i][j] = nullptr;
-        }
-    }
+ChessBoard::ChessBoard(glm::vec3 position) : ChessBoard() {
+    init(position);
+}
+
+void ChessBoard::init(glm::vec3 position) {
+    boardPosition = position;
+    this->position.set(START_FEN);
+    attackMap.compute(this->position);
+    keyHistory.assign(1, this->position.key());
+    updateStatus();
+    setupPieces();
+
+    generateBoardMesh();
+    generateCheckerboardTexture();
+}
 
+void ChessBoard::setupPieces() {
     // Initialize the white pieces
-    addPiece(new ChessPiece(0, 0, 0, "rook", "white"), 0, 0);
-    addPiece(new ChessPiece(1, 0, 0, "knight", "white"), 1, 0);
-    addPiece(new ChessPiece(2, 0, 0, "bishop", "white"), 2, 0);
-    addPiece(new ChessPiece(3, 0, 0, "queen", "white"), 3, 0);
-    addPiece(new ChessPiece(4, 0, 0, "king", "white"), 4, 0);
-    addPiece(new ChessPiece(5, 0, 0, "bishop", "white"), 5, 0);
-    addPiece(new ChessPiece(6, 0, 0, "knight", "white"), 6, 0);
-    addPiece(new ChessPiece(7, 0, 0, "rook", "white"), 7, 0);
+    addPiece(new ChessPiece(0, 0, 0, ROOK, WHITE), 0, 0);
+    addPiece(new ChessPiece(1, 0, 0, KNIGHT, WHITE), 1, 0);
+    addPiece(new ChessPiece(2, 0, 0, BISHOP, WHITE), 2, 0);
+    addPiece(new ChessPiece(3, 0, 0, QUEEN, WHITE), 3, 0);
+    addPiece(new ChessPiece(4, 0, 0, KING, WHITE), 4, 0);
+    addPiece(new ChessPiece(5, 0, 0, BISHOP, WHITE), 5, 0);
+    addPiece(new ChessPiece(6, 0, 0, KNIGHT, WHITE), 6, 0);
+    addPiece(new ChessPiece(7, 0, 0, ROOK, WHITE), 7, 0);
 
     for (int i = 0; i < 8; ++i) {
-        addPiece(new ChessPiece(i, 1, 0, "pawn", "white"), i, 1);
+        addPiece(new ChessPiece(i, 1, 0, PAWN, WHITE), i, 1);
     }
 
     // Initialize the black pieces
-    addPiece(new ChessPiece(0, 7, 0, "rook", "black"), 0, 7);
-    addPiece(new ChessPiece(1, 7, 0, "knight", "black"), 1, 7);
-    addPiece(new ChessPiece(2, 7, 0, "bishop", "black"), 2, 7);
-    addPiece(new ChessPiece(3, 7, 0, "queen", "black"), 3, 7);
-    addPiece(new ChessPiece(4, 7, 0, "king", "black"), 4, 7);
-    addPiece(new ChessPiece(5, 7, 0, "bishop", "black"), 5, 7);
-    addPiece(new ChessPiece(6, 7, 0, "knight", "black"), 6, 7);
-    addPiece(new ChessPiece(7, 7, 0, "rook", "black"), 7, 7);
+    addPiece(new ChessPiece(0, 7, 0, ROOK, BLACK), 0, 7);
+    addPiece(new ChessPiece(1, 7, 0, KNIGHT, BLACK), 1, 7);
+    addPiece(new ChessPiece(2, 7, 0, BISHOP, BLACK), 2, 7);
+    addPiece(new ChessPiece(3, 7, 0, QUEEN, BLACK), 3, 7);
+    addPiece(new ChessPiece(4, 7, 0, KING, BLACK), 4, 7);
+    addPiece(new ChessPiece(5, 7, 0, BISHOP, BLACK), 5, 7);
+    addPiece(new ChessPiece(6, 7, 0, KNIGHT, BLACK), 6, 7);
+    addPiece(new ChessPiece(7, 7, 0, ROOK, BLACK), 7, 7);
 
     for (int i = 0; i < 8; ++i) {
-        addPiece(new ChessPiece(i, 6, 0, "pawn", "black"), i, 6);
+        addPiece(new ChessPiece(i, 6, 0, PAWN, BLACK), i, 6);
     }
-
-    generateBoardMesh();
-    generateCheckerboardTexture();
 }
 
 void ChessBoard::addPiece(ChessPiece* piece, int x, int y) {
@@ -138,318 +142,157 @@ void ChessBoard::render() {
 
 vector<ChessPiece*> ChessBoard::sortTakenPieces(vector<ChessPiece*>& pieces) {
     sort(pieces.begin(), pieces.end(), [](const ChessPiece* a, const ChessPiece* b) {
-        map<string, int> importance = {{"queen", 1}, {"rook", 2}, {"bishop", 3}, {"knight", 4}, {"pawn", 5}};
+        // Indexed by PieceType, queens first
+        static const int importance[] = {5, 4, 3, 2, 1, 0};
         return importance[a->getType()] < importance[b->getType()];
     });
     return pieces;
 }
 
-pair<int, int> ChessBoard::getPositionFromNotation(const string& notation) {
-    int file = notation[0] - 'a';  // Convert 'a' to 'h' to 0-7 (column)
-    int rank = notation[1] - '1';  // Convert '1' to '8' to 0-7 (row)
-    return {file, rank};
+bool ChessBoard::inCheck(Color player) {
+    return status.check && status.sideToMove == player;
 }
 
-bool ChessBoard::inCheck(const string& player) {
-    // Find the king's position
-    int kingRow = -1;
-    int kingCol = -1;
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            if (board[i][j] != nullptr && board[i][j]->getType() == "king" && board[i][j]->getPlayer() == player) {
-                kingRow = i;
-                kingCol = j;
-                break;
-            }
-        }
-    }
-
-    if (kingRow == -1 || kingCol == -1) {
-        cerr << "Could not find the " << player << " king." << endl;
-        return false;
-    }
-    
-    // Check if any opponent pieces can attack the king
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            if (board[i][j] != nullptr && board[i][j]->getPlayer() == ((player == "white") ? "black" : "white")) {
-                string kingPosition = string(1, 'a' + kingCol) + to_string(kingRow + 1);
-                string move = board[i][j]->getBoardLocation() + kingPosition;
-                if (validMove(move, true)) {
-                    whiteInCheck = player == "white";
-                    blackInCheck = player == "black";
-                    return true;
-                }
-            }
-        }
-    }
+bool ChessBoard::checkMated(Color player) {
+    return status.checkmate && status.sideToMove == player;
+}
 
-    if (player == "white") whiteInCheck = false;
-    if (player == "black") blackInCheck = false;
+bool ChessBoard::staleMated(Color player) {
+    return status.stalemate() && status.sideToMove == player;
+}
 
-    return false;
+void ChessBoard::updateStatus() {
+    status = computeGameStatus(position, keyHistory, &attackMap);
 }
 
-bool ChessBoard::checkMated(const string& player) {
-    // Check if there are any valid moves for the player
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            if (board[i][j] != nullptr && board[i][j]->getPlayer() == player) {
-                for (int k = 0; k < 8; ++k) {
-                    for (int l = 0; l < 8; ++l) {
-                        string move = board[i][j]->getBoardLocation() + string(1, 'a' + l) + to_string(k + 1);
-                        if (testMove(move)) {
-                            return false;
-                        }
-                    }
-                }
-            }
+vector<Move> ChessBoard::getLegalMoves(int square) {
+    vector<Move> result;
+    MoveList list;
+    generateLegalMoves(position, list, &attackMap);
+    for (const Move& move : list) {
+        // Promotions are listed once, the promotion piece is picked when the move is made
+        if (move.from() == square && (move.promotion() == NO_PIECE_TYPE || move.promotion() == QUEEN)) {
+            result.push_back(move);
         }
     }
-
-    return true;
+    return result;
 }
 
-bool ChessBoard::validMove(const string& move, bool errorsOff, bool checkCastling) {
-    if (move.length() != 4) return false;
-
-    int fromCol = move[0] - 'a';
-    int fromRow = move[1] - '0' - 1;
-    int toCol = move[2] - 'a';
-    int toRow = move[3] - '0' - 1;
-
-    ChessPiece* piece = board[fromRow][fromCol];
-    if (piece == nullptr) {
-        cerr << "No piece at source position: " << move.substr(0, 2) << endl;
-        return false;
-    }
-
-    // Check if it is the player's turn
-    if (!errorsOff && playerTurn != piece->getPlayer()) {
-        cerr << "It is the opponent's turn." << endl;
-        return false;
-    }
-
-    // Validate the move based on the piece type
-    if (piece->getType() == "pawn") {
-        return isValidPawnMove(fromRow, fromCol, toRow, toCol, piece, errorsOff);
-    } else if (piece->getType() == "knight") {
-        return isValidKnightMove(fromRow, fromCol, toRow, toCol, errorsOff);
-    } else if (piece->getType() == "bishop") {
-        return isValidBishopMove(fromRow, fromCol, toRow, toCol, errorsOff);
-    } else if (piece->getType() == "rook") {
-        return isValidRookMove(fromRow, fromCol, toRow, toCol, errorsOff);
-    } else if (piece->getType() == "queen") {
-        return isValidQueenMove(fromRow, fromCol, toRow, toCol, errorsOff);
-    } else if (piece->getType() == "king") {
-        return isValidKingMove(fromRow, fromCol, toRow, toCol, errorsOff, checkCastling);
+void ChessBoard::updateSelection() {
+    int square = notationToSquare(selectedPieceLocation);
+    if (square == selectedMovesSquare && position.key() == selectedMovesKey) return;
+
+    selectedMoves = MoveList();
+    Bitboard targets = 0;
+    if (square != NO_SQUARE) {
+        MoveList list;
+        generateLegalMoves(position, list, &attackMap);
+        for (const Move& move : list) {
+            // Promotions are listed once, clicking the square promotes to a queen
+            if (move.from() == square && (move.promotion() == NO_PIECE_TYPE || move.promotion() == QUEEN)) {
+                selectedMoves.add(move);
+                targets |= squareBB(move.to());
+            }
+        }
     }
-
-    return false;
+    selectedMovesSquare = square;
+    selectedMovesKey = position.key();
+    highlightSquares(targets);
 }
 
-bool ChessBoard::isValidPawnMove(int fromRow, int fromCol, int toRow, int toCol, ChessPiece* piece, bool errorsOff) {
-    bool isWhite = piece->getPlayer() == "white";
-    int direction = (isWhite) ? 1 : -1; // White pawns move up, black pawns move down
-    int startRow = (isWhite) ? 1 : 6; // Starting row for white and black pawns
-
-    // Move forward by one square
-    if (fromCol == toCol && toRow == fromRow + direction && board[toRow][toCol] == nullptr) {
-        return true;
-    }
-
-    // Move forward by two squares from the starting position
-    if (fromCol == toCol && fromRow == startRow && toRow == fromRow + 2 * direction && board[toRow][toCol] == nullptr && board[fromRow + direction][toCol] == nullptr) {
-        return true;
-    }
-
-    // Capture diagonally
-    if (abs(fromCol - toCol) == 1 && toRow == fromRow + direction && board[toRow][toCol] != nullptr && board[toRow][toCol]->getPlayer() != piece->getPlayer()) {
-        return true;
-    }
-
-    return false;
+bool ChessBoard::isSelectedMove(Move move) const {
+    return selectedMovesKey == position.key() && find(selectedMoves.begin(), selectedMoves.end(), move) != selectedMoves.end();
 }
 
-bool ChessBoard::isValidKnightMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff) {
-    if (board[toRow][toCol] != nullptr && board[toRow][toCol]->getPlayer() == board[fromRow][fromCol]->getPlayer()) {
-        if (!errorsOff) cerr << "Destination square occupied by friendly piece!" << endl;
-        return false;
-    }
-    return (abs(fromRow - toRow) == 2 && abs(fromCol - toCol) == 1) ||
-            (abs(fromRow - toRow) == 1 && abs(fromCol - toCol) == 2);
-}
+bool ChessBoard::validMove(Move move, bool errorsOff) {
+    int from = move.from();
+    int to = move.to();
+    if (move.isNone()) return false;
 
-bool ChessBoard::isValidBishopMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff) {
-    if (abs(fromRow - toRow) != abs(fromCol - toCol)) {
-        if (!errorsOff) cerr << "Bishop can only move diagonally!" << endl;
+    if (position.empty(from)) {
+        if (!errorsOff) cerr << "No piece at source position: " << squareToNotation(from) << endl;
         return false;
     }
 
-    int rowDirection = (toRow > fromRow) ? 1 : -1;
-    int colDirection = (toCol > fromCol) ? 1 : -1;
-
-    // Check each square along the diagonal path for obstacles
-    int row = fromRow + rowDirection;
-    int col = fromCol + colDirection;
-    while (row != toRow && col != toCol) {
-        if (board[row][col] != nullptr) {
-            if (!errorsOff) cerr << "Piece blocking the bishop's path!" << endl;
-            return false;
-        }
-        row += rowDirection;
-        col += colDirection;
-    }
-
-    // Check if the destination square is occupied by a piece of the same player
-    if (board[toRow][toCol] != nullptr && board[toRow][toCol]->getPlayer() == board[fromRow][fromCol]->getPlayer()) {
-        if (!errorsOff) cerr << "Destination square occupied by friendly piece!" << endl;
+    // Check if it is the player's turn
+    if (position.colorOn(from) != position.sideToMove()) {
+        if (!errorsOff) cerr << "It is the opponent's turn." << endl;
         return false;
     }
 
-    return true;
-}
-
-bool ChessBoard::isValidRookMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff) {
-    if (fromRow != toRow && fromCol != toCol) {
-        if (!errorsOff) cerr << "Rook can only move in a straight line!" << endl;
+    if (!position.isPseudoLegal(from, to)) {
+        if (!errorsOff) cerr << "Illegal move for " << pieceTypeName(board[rankOf(from)][fileOf(from)]->getType()) << ": " << move.toString() << endl;
         return false;
     }
 
-    int rowDirection = (toRow > fromRow) ? 1 : (toRow < fromRow) ? -1 : 0;
-    int colDirection = (toCol > fromCol) ? 1 : (toCol < fromCol) ? -1 : 0;
-
-    // Check each square along the path for obstacles
-    int row = fromRow + rowDirection;
-    int col = fromCol + colDirection;
-    while (row != toRow || col != toCol) {
-        if (board[row][col] != nullptr) {
-            if (!errorsOff) cerr << "Piece blocking path: " << board[row][col]->getType() << " at " << row << ", " << col << endl;
-            return false;
-        }
-        row += rowDirection;
-        col += colDirection;
+    // Moves received from outside must carry the flag the position implies
+    if (move != makeMove(position, from, to, move.promotion())) {
+        if (!errorsOff) cerr << "Move flags do not match the position: " << move.toString() << endl;
+        return false;
     }
 
-    // Check if the destination square is occupied by a piece of the same player
-    if (board[toRow][toCol] != nullptr && board[toRow][toCol]->getPlayer() == board[fromRow][fromCol]->getPlayer()) {
-        if (!errorsOff) cerr << "Destination square occupied by friendly piece!" << endl;
+    if (!position.isLegal(from, to)) {
+        if (!errorsOff) cerr << ((position.sideToMove() == WHITE) ? "White" : "Black") << " in check!" << endl;
         return false;
     }
 
     return true;
 }
 
-bool ChessBoard::isValidQueenMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff) {
-    return isValidRookMove(fromRow, fromCol, toRow, toCol, true) ||
-            isValidBishopMove(fromRow, fromCol, toRow, toCol, true);
+bool ChessBoard::squareUnderAttackBy(int square, Color player) {
+    return attackMap.isAttacked(square, player);
 }
 
-bool ChessBoard::isValidKingMove(int fromRow, int fromCol, int toRow, int toCol, bool errorsOff, bool checkCastling) {
-    if (board[toRow][toCol] != nullptr && board[toRow][toCol]->getPlayer() == board[fromRow][fromCol]->getPlayer()) {
-        if (!errorsOff) cerr << "Destination square occupied by friendly piece!" << endl;
-        return false;
-    }
-    bool valid = abs(fromRow - toRow) <= 1 && abs(fromCol - toCol) <= 1;
-
-    // Check for castling
-    if (checkCastling && !((board[fromRow][fromCol]->getPlayer() == "white") ? whiteInCheck : blackInCheck) && !board[fromRow][fromCol]->getHasMoved() && ((fromRow == 0 && fromCol == 4) || (fromRow == 7 && fromCol == 4))) {
-        // Kingside castling
-        if ((toRow == 0 && toCol == 6 && board[0][5] == nullptr && board[0][6] == nullptr && board[0][7] != nullptr && board[0][7]->getType() == "rook" && !board[0][7]->getHasMoved() &&
-             !squareUnderAttackBy("e1", "black") && !squareUnderAttackBy("f1", "black") && !squareUnderAttackBy("g1", "black")) ||
-            (toRow == 7 && toCol == 6 && board[7][5] == nullptr && board[7][6] == nullptr && board[7][7] != nullptr && board[7][7]->getType() == "rook" && !board[7][7]->getHasMoved() &&
-             !squareUnderAttackBy("e8", "white") && !squareUnderAttackBy("f8", "white") && !squareUnderAttackBy("g8", "white"))) {
-            valid = true;
-            if (!errorsOff) {
-                movePiece((playerTurn == "white") ? "h1f1" : "h8f8", false);
-                playerTurn = (playerTurn == "white") ? "black" : "white";
-                FEN = decrementFullMoveCounter(FEN);
-                castleSound.play();
-            }
-        }
-        // Queenside castling
-        if ((toRow == 0 && toCol == 2 && board[0][1] == nullptr && board[0][2] == nullptr && board[0][3] == nullptr && board[0][0] != nullptr && board[0][0]->getType() == "rook" && !board[0][0]->getHasMoved() &&
-             !squareUnderAttackBy("e1", "black") && !squareUnderAttackBy("d1", "black") && !squareUnderAttackBy("c1", "black")) ||
-            (toRow == 7 && toCol == 2 && board[7][1] == nullptr && board[7][2] == nullptr && board[7][3] == nullptr && board[7][0] != nullptr && board[7][0]->getType() == "rook" && !board[7][0]->getHasMoved() &&
-             !squareUnderAttackBy("e8", "white") && !squareUnderAttackBy("d8", "white") && !squareUnderAttackBy("c8", "white"))) {
-            valid = true;
-            if (!errorsOff) {
-                movePiece((playerTurn == "white") ? "a1d1" : "a8d8", false);
-                playerTurn = (playerTurn == "white") ? "black" : "white";
-                FEN = decrementFullMoveCounter(FEN);
-                castleSound.play();
-            }
-        }
-    }
-    return valid;
+void ChessBoard::animatePiece(ChessPiece* piece, pair<int, int> src, pair<int, int> dst) {
+    board[dst.second][dst.first] = piece;
+    board[src.second][src.first] = nullptr;
+    // Set the destination board location of the piece and animate it there
+    piece->setBoardLocation(squareName(makeSquare(dst.first, dst.second)));
+    piece->setHasMoved(true);
+    animating = true;
+    thread animateThread([piece, dst, this]() {
+        piece->animateMove(dst.first, dst.second, 0.0f, ref(this->animating));
+    });
+    animateThread.detach();
 }
 
-bool ChessBoard::squareUnderAttackBy(string square, string player) {
-    // Check if any opponent pieces can attack the square
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            if (board[i][j] != nullptr && board[i][j]->getPlayer() == player) {
-                string move = board[i][j]->getBoardLocation() + square;
-                if (validMove(move, true, false)) {
-                    return true;
-                }
-            }
+void ChessBoard::movePiece(Move move, bool sendMoveToMultiplayerOpponent) {
+    // Moves picked from the selected piece's legal moves were generated legal and need no checks
+    if (!isSelectedMove(move) && !validMove(move)) {
+        cerr << "Invalid move: " << move.toString() << endl;
+        vector<Move> hints = getLegalMoves(move.from());
+        if (!hints.empty()) {
+            cerr << "Legal moves from " << squareToNotation(move.from()) << ":";
+            for (const Move& hint : hints) cerr << " " << hint.toString();
+            cerr << endl;
         }
+        illegalSound.play();
+        return;
     }
-    return false;
-}
-
-void ChessBoard::movePiece(const string& move, bool sendMoveToMultiplayerOpponent) {
-    pair<int, int> src = getPositionFromNotation(move.substr(0, 2));
-    pair<int, int> dst = getPositionFromNotation(move.substr(2, 2));
 
+    pair<int, int> src = {fileOf(move.from()), rankOf(move.from())};
+    pair<int, int> dst = {fileOf(move.to()), rankOf(move.to())};
     ChessPiece* piece = board[src.second][src.first];
 
-    if (move.length() < 4 || move.length() > 5) {
-        cerr << "Invalid move string: " << move << endl;
-        return;
-    } else if (!validMove(move.substr(0, 4))) {
-        if (piece != nullptr) {
-            cerr << "Invalid move by " << piece->getPlayer() << ": " << move << endl;
-        } else {
-            cerr << "Invalid move: " << move << endl;
-        }
-        illegalSound.play();
-        return;
-    }
+    // The kind of move is read from the position, like makeMove does, so the move's flag bits are not trusted
+    bool castling = position.isCastling(move.from(), move.to());
 
-    // Save the piece pointer that was at the destination
-    ChessPiece* capturedPiece = board[dst.second][dst.first];
+    // En passant captures the pawn beside the source square instead of on the destination
+    pair<int, int> capturedLocation = position.isEnPassant(move.from(), move.to()) ? make_pair(dst.first, src.second) : dst;
+    ChessPiece* capturedPiece = board[capturedLocation.second][capturedLocation.first];
 
-    // Move the piece to the destination position
-    board[dst.second][dst.first] = piece;
-    board[src.second][src.first] = nullptr;
-    piece->setPosition(dst.first, dst.second, 0);
-
-    bool playNormalMoveSound = true;
-    bool whiteInCheck = inCheck("white");
-    bool blackInCheck = inCheck("black");
-    if (piece->getPlayer() == "white" && whiteInCheck) {
-        // Revert white's move if it puts white in check
-        board[dst.second][dst.first] = capturedPiece;
-        board[src.second][src.first] = piece;
-        piece->setPosition(src.first, src.second, 0);
-        cerr << "White in check!" << endl;
-        illegalSound.play();
-        return;
-    } else if (piece->getPlayer() == "black" && blackInCheck) {
-        // Revert black's move if it puts black in check
-        board[dst.second][dst.first] = capturedPiece;
-        board[src.second][src.first] = piece;
-        piece->setPosition(src.first, src.second, 0);
-        cerr << "Black in check!" << endl;
-        illegalSound.play();
-        return;
-    } else if (piece->getPlayer() == "white" && blackInCheck || piece->getPlayer() == "black" && whiteInCheck) {
-        checkSound.play();
-        playNormalMoveSound = false;
+    BoardUndo undo = {move, UndoInfo(), capturedPiece, piece->getHasMoved(), false};
+    if (castling) {
+        undo.rookHadMoved = board[src.second][(dst.first > src.first) ? 7 : 0]->getHasMoved();
     }
 
+    Position before = position;
+    position.makeMove(move, undo.state);
+    undoStack.push_back(undo);
+    attackMap.update(before, position);
+    keyHistory.push_back(position.key());
+    updateStatus();
+
     /**
      * If there was a piece at the destination, remove it from the pieces vector
      * and put it in the appropriate taken pieces vector
@@ -457,87 +300,101 @@ void ChessBoard::movePiece(const string& move, bool sendMoveToMultiplayerOpponen
     if (capturedPiece != nullptr) {
         captureSound.play();
         capturedPiece->setTaken(true);
-        if (capturedPiece->getPlayer() == "white") {
+        board[capturedLocation.second][capturedLocation.first] = nullptr;
+        if (capturedPiece->getPlayer() == WHITE) {
             takenWhitePieces.push_back(capturedPiece);
         } else {
             takenBlackPieces.push_back(capturedPiece);
         }
-        
+
         auto it = find(pieces.begin(), pieces.end(), capturedPiece);
         if (it != pieces.end()) {
             pieces.erase(it);
         }
     }
 
-    // Check for pawn promotion default to queen if unspecified
-    if (piece->getType() == "pawn" && (dst.second == 7 || dst.second == 0)) {
-        char promotionType = (move.length() == 5) ? move[4] : 'q';
-        string promotionTypeStr;
-        switch (promotionType) {
-            case 'q': promotionTypeStr = "queen"; break;
-            case 'r': promotionTypeStr = "rook"; break;
-            case 'b': promotionTypeStr = "bishop"; break;
-            case 'n': promotionTypeStr = "knight"; break;
-            default: promotionTypeStr = "queen"; break;
-        }
-        piece->convertTo(promotionTypeStr);
-        // Put the piece back to its original position and animate the move
-        piece->setPosition(src.first, src.second, 0);
-        // Set the destination board location of the piece
-        piece->setBoardLocation(string(1, 'a' + dst.first) + to_string(dst.second + 1));
-        animating = true;
-        thread animateThread([piece, dst, this]() {
-            piece->animateMove(dst.first, dst.second, 0.0f, ref(this->animating));
-        });
-        animateThread.detach();
-        FEN = appendMoveToFEN(FEN, move);
-        FEN = changePieceAtLocation(FEN, move.substr(2, 2), promotionTypeStr, piece->getPlayer());
-    } else {
-        // Put the piece back to its original position and animate the move
-        piece->setPosition(src.first, src.second, 0);
-        // Set the destination board location of the piece
-        piece->setBoardLocation(string(1, 'a' + dst.first) + to_string(dst.second + 1));
-        animating = true;
-        thread animateThread([piece, dst, this]() {
-            piece->animateMove(dst.first, dst.second, 0.0f, ref(this->animating));
-        });
-        animateThread.detach();
-        piece->setHasMoved(true);
-        FEN = appendMoveToFEN(FEN, move);
+    if (undo.state.flag == PROMOTION_MOVE) {
+        piece->convertTo(position.typeOn(move.to()));
+    }
+    animatePiece(piece, src, dst);
+
+    // Castling also hops the rook over the king
+    if (castling) {
+        int rookFromCol = (dst.first > src.first) ? 7 : 0;
+        int rookToCol = (dst.first > src.first) ? 5 : 3;
+        animatePiece(board[src.second][rookFromCol], {rookFromCol, src.second}, {rookToCol, src.second});
+        castleSound.play();
     }
 
     if (sendMoveToMultiplayerOpponent && multiplayer && playerTurn == playerColor) sendMove(move);
-    playerTurn = (playerTurn == "white") ? "black" : "white";
-    if (playNormalMoveSound) moveSound.play();
+    playerTurn = ~playerTurn;
+    if (status.check) {
+        checkSound.play();
+    } else {
+        moveSound.play();
+    }
 }
 
-bool ChessBoard::testMove(const string& move) {
-    if (move.length() != 4) {
-        cerr << "Invalid move string: " << move << endl;
-        return false;
-    } else if (!validMove(move, true)) {
-        return false;
+void ChessBoard::undoLastMove() {
+    BoardUndo undo = undoStack.back();
+    undoStack.pop_back();
+    Move move = undo.move;
+    pair<int, int> src = {fileOf(move.from()), rankOf(move.from())};
+    pair<int, int> dst = {fileOf(move.to()), rankOf(move.to())};
+    ChessPiece* piece = board[dst.second][dst.first];
+
+    Position after = position;
+    position.unmakeMove(move, undo.state);
+    attackMap.update(after, position);
+    keyHistory.pop_back();
+    updateStatus();
+
+    if (undo.state.flag == PROMOTION_MOVE) {
+        piece->convertTo(PAWN);
+    }
+    animatePiece(piece, dst, src);
+    piece->setHasMoved(undo.pieceHadMoved);
+
+    if (undo.state.flag == CASTLING_MOVE) {
+        int rookFromCol = (dst.first > src.first) ? 7 : 0;
+        int rookToCol = (dst.first > src.first) ? 5 : 3;
+        ChessPiece* rook = board[src.second][rookToCol];
+        animatePiece(rook, {rookToCol, src.second}, {rookFromCol, src.second});
+        rook->setHasMoved(undo.rookHadMoved);
+    }
+
+    // Put the captured piece back on the board
+    if (undo.captured != nullptr) {
+        pair<int, int> capturedLocation = (undo.state.flag == EN_PASSANT_MOVE) ? make_pair(dst.first, src.second) : dst;
+        vector<ChessPiece*>& taken = (undo.captured->getPlayer() == WHITE) ? takenWhitePieces : takenBlackPieces;
+        auto it = find(taken.begin(), taken.end(), undo.captured);
+        if (it != taken.end()) {
+            taken.erase(it);
+        }
+        undo.captured->setTaken(false);
+        undo.captured->setHovered(false);
+        undo.captured->setPosition(capturedLocation.first, capturedLocation.second, 0);
+        board[capturedLocation.second][capturedLocation.first] = undo.captured;
+        pieces.push_back(undo.captured);
     }
 
-    pair<int, int> src = getPositionFromNotation(move.substr(0, 2));
-    pair<int, int> dst = getPositionFromNotation(move.substr(2, 2));
-
-    ChessPiece* piece = board[src.second][src.first];
-
-    // Save the piece pointer at the destination
-    ChessPiece* capturedPiece = board[dst.second][dst.first];
-
-    // Move the piece to the destination position
-    board[dst.second][dst.first] = piece;
-    board[src.second][src.first] = nullptr;
+    playerTurn = ~playerTurn;
+}
 
-    bool check = inCheck(piece->getPlayer());
+void ChessBoard::takeBack() {
+    if (multiplayer || animating || opponentProcessing || undoStack.empty()) return;
 
-    // Revert the move
-    board[dst.second][dst.first] = capturedPiece;
-    board[src.second][src.first] = piece;
+    undoLastMove();
+    // Against the engine also take back the player's own move
+    if (!overrideMode && playerTurn != playerColor && !undoStack.empty()) {
+        undoLastMove();
+    }
 
-    return !check;
+    // A reply computed for the old position no longer applies
+    opponentMove = MOVE_NONE;
+    checkMatedTime = 0;
+    selectedPieceLocation = "";
+    moveSound.play();
 }
 
 string ChessBoard::getSquareAtCenter() {
@@ -559,7 +416,7 @@ string ChessBoard::getSquareAtCenter() {
     if (x < 0 || x >= 8 || y < 0 || y >= 8) {
         return "";
     }
-    return string(1, 'a' + x) + to_string(y + 1);
+    return squareName(makeSquare(x, y));
 }
 
 void ChessBoard::checkHoveredPieces() {
@@ -589,21 +446,25 @@ void ChessBoard::userInteraction() {
         selectedPieceLocation = "";
         while (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {glfwPollEvents();}
     } else if (!animating && targetPointerLocation != "" && glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
-        movePiece(selectedPieceLocation + targetPointerLocation);
+        updateSelection();
+        int from = notationToSquare(selectedPieceLocation);
+        int to = notationToSquare(targetPointerLocation);
+        if (from != NO_SQUARE) movePiece(makeMove(position, from, to));
         selectedPieceLocation = "";
         while (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {glfwPollEvents();}
     }
+    updateSelection();
 
     // Check if the game is over
-    if (checkMatedTime == 0 && checkMated("black")) {
-        checkMatedTime = glfwGetTime();
-        cerr << "Checkmate! White wins!" << endl;
-        checkmateSound.play();
-    } else if (checkMatedTime == 0 && checkMated("white")) {
+    if (checkMatedTime == 0 && status.gameOver()) {
         checkMatedTime = glfwGetTime();
-        cerr << "Checkmate! Black wins!" << endl;
+        if (status.checkmate) {
+            cerr << ((status.sideToMove == BLACK) ? "Checkmate! White wins!" : "Checkmate! Black wins!") << endl;
+        } else {
+            cerr << "Draw by " << drawReasonToString(status.draw) << "." << endl;
+        }
         checkmateSound.play();
-    } else if (checkMated("black") || checkMated("white")) {
+    } else if (status.gameOver()) {
         double elapsed = glfwGetTime() - checkMatedTime;
         float expectedDuration = 3.0f;
         if ((!opponentProcessing || multiplayer) && elapsed >= expectedDuration) {
@@ -619,46 +480,71 @@ void ChessBoard::update() {
         reset();
     }
 
+    // The server refused our last move, so it is taken back to match the server's position
+    if (moveRejected && !animating) {
+        moveRejected = false;
+        if (!undoStack.empty()) {
+            undoLastMove();
+        }
+        opponentProcessing = false;
+        opponentMove = MOVE_NONE;
+        checkMatedTime = 0;
+        selectedPieceLocation = "";
+    }
+
     // Check if it is the opponent's turn and get the opponent's move
-    if (!overrideMode && !animating && playerTurn != playerColor && !opponentProcessing && !opponentMoveReceived) {
-        opponentProcessing = true;
-        thread opponentThread(&ChessBoard::getOpponentMove, this);
-        opponentThread.detach();
-    } else if (!overrideMode && !animating && playerTurn != playerColor && !opponentProcessing && opponentMoveReceived) {
-        // Execute the opponent's move
-        movePiece(opponentMove);
-        opponentMove = "";
-        opponentMoveReceived = false;
+    if (!overrideMode && !animating && playerTurn != playerColor && !status.gameOver()) {
+        if (!opponentProcessing) {
+            opponentProcessing = true;
+            opponentRequestTime = glfwGetTime();
+            if (!multiplayer) {
+                Position start;
+                start.set(START_FEN);
+                opponentRequest = stockfish.requestMove(start, getMoveHistory());
+            }
+        } else {
+            pollOpponentMove();
+        }
     }
     userInteraction();
 }
 
-void ChessBoard::getOpponentMove() {
-    auto start = chrono::high_resolution_clock::now();
-    
-    string move;
+vector<Move> ChessBoard::getMoveHistory() const {
+    vector<Move> moves;
+    moves.reserve(undoStack.size());
+    for (const BoardUndo& undo : undoStack) {
+        moves.push_back(undo.move);
+    }
+    return moves;
+}
+
+void ChessBoard::pollOpponentMove() {
+    bool answered;
     if (multiplayer) {
-        move = getMultiplayerMove();
+        if (opponentMove.isNone()) {
+            opponentMove = getMultiplayerMove();
+        }
+        answered = !opponentMove.isNone();
     } else {
-        move = stockfish.getMove(FEN);
+        answered = opponentRequest.ready();
     }
-
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> elapsed = end - start;
-    float expectedDuration = 1.0f;
-    // Wait for at least 1 second before returning the move
-    if (elapsed.count() < expectedDuration) {
-        this_thread::sleep_for(chrono::duration<double>(expectedDuration - elapsed.count()));
+    // Wait for at least OPPONENT_MIN_DELAY before playing the move
+    if (!answered || glfwGetTime() - opponentRequestTime < OPPONENT_MIN_DELAY) {
+        return;
     }
 
-    if (move.empty()) {
+    Move move = opponentMove;
+    if (!multiplayer) {
+        move = opponentRequest.get();
+        opponentRequest = MoveRequest();
+    }
+    opponentMove = MOVE_NONE;
+    opponentProcessing = false;
+    if (move.isNone()) {
         cout << "Game Over" << endl;
-        opponentProcessing = false;
         return;
     }
-    opponentMove = move;
-    opponentProcessing = false;
-    opponentMoveReceived = true;
+    movePiece(move);
 }
 
 void ChessBoard::generateBoardMesh() {
@@ -706,21 +592,32 @@ void ChessBoard::generateBoardMesh() {
     modelMatrix = glm::scale(modelMatrix, glm::vec3(1.2f, 1.0f, 1.2f));
 }
 
+/**
+ * @brief Writes the color of one board square into an RGB pixel.
+ */
+static void squareColor(int file, int rank, bool highlighted, unsigned char* rgb) {
+    bool dark = file % 2 == rank % 2;
+    if (highlighted) {
+        rgb[0] = dark ? 40 : 130;
+        rgb[1] = dark ? 110 : 210;
+        rgb[2] = dark ? 40 : 130;
+    } else {
+        rgb[0] = rgb[1] = rgb[2] = dark ? 0 : 255;
+    }
+}
+
 void ChessBoard::generateCheckerboardTexture() {
-    int width = 512;
-    int height = 512;
+    int width = BOARD_TEXTURE_SIZE;
+    int height = BOARD_TEXTURE_SIZE;
     int squareSize = width / 8;
     vector<unsigned char> data(width * height * 3);
 
+    // Texture columns run along the files and rows along the ranks
     for (int y = 0; y < height; ++y) {
         for (int x = 0; x < width; ++x) {
             int squareX = x / squareSize;
             int squareY = y / squareSize;
-            unsigned char color = (squareX % 2 == squareY % 2) ? 0 : 255;
-
-            data[(y * width + x) * 3 + 0] = color; // R
-            data[(y * width + x) * 3 + 1] = color; // G
-            data[(y * width + x) * 3 + 2] = color; // B
+            squareColor(squareX, squareY, highlightedSquares & squareBB(makeSquare(squareX, squareY)), &data[(y * width + x) * 3]);
         }
     }
 
@@ -736,18 +633,54 @@ void ChessBoard::generateCheckerboardTexture() {
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void ChessBoard::highlightSquares(Bitboard squares) {
+    Bitboard changed = squares ^ highlightedSquares;
+    highlightedSquares = squares;
+    if (!changed || boardTexture == 0) return;
+
+    // Only the squares that changed are uploaded, one square sized block each
+    int squareSize = BOARD_TEXTURE_SIZE / 8;
+    vector<unsigned char> block(squareSize * squareSize * 3);
+    glBindTexture(GL_TEXTURE_2D, boardTexture);
+    while (changed) {
+        int square = popLsb(changed);
+        unsigned char rgb[3];
+        squareColor(fileOf(square), rankOf(square), squares & squareBB(square), rgb);
+        for (int i = 0; i < squareSize * squareSize; ++i) {
+            block[i * 3 + 0] = rgb[0];
+            block[i * 3 + 1] = rgb[1];
+            block[i * 3 + 2] = rgb[2];
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, fileOf(square) * squareSize, rankOf(square) * squareSize,
+                        squareSize, squareSize, GL_RGB, GL_UNSIGNED_BYTE, block.data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void ChessBoard::reset() {
+    // A search for the old game is stopped, its answer must not land on the new board
+    opponentRequest.cancel();
+    opponentRequest = MoveRequest();
+    opponentProcessing = false;
+    opponentMove = MOVE_NONE;
+    if (!multiplayer) {
+        stockfish.newGame();
+    }
+
     gameRunning = false;
-    playerTurn = "white";
-    FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    playerTurn = WHITE;
     hoveredPieceLocation = "";
     selectedPieceLocation = "";
     targetPointerLocation = "";
     checkMatedTime = 0;
-    whiteInCheck = false;
-    blackInCheck = false;
-
-    if (playerColor == "white") {
+    position.set(START_FEN);
+    attackMap.compute(position);
+    keyHistory.assign(1, position.key());
+    undoStack.clear();
+    updateStatus();
+    updateSelection();
+
+    if (playerColor == WHITE) {
         camera = Camera(glm::vec3(0.0f, 3.0f, -2.5f), glm::vec3(0.0f, 0.0f, 0.0f), 90.0f, -50.0f);
     } else {
         camera = Camera(glm::vec3(0.0f, 3.0f, 2.5f), glm::vec3(0.0f, 0.0f, 0.0f), -90.0f, -50.0f);
@@ -777,31 +710,5 @@ void ChessBoard::reset() {
     }
     takenBlackPieces.clear();
 
-    // Initialize the white pieces
-    addPiece(new ChessPiece(0, 0, 0, "rook", "white"), 0, 0);
-    addPiece(new ChessPiece(1, 0, 0, "knight", "white"), 1, 0);
-    addPiece(new ChessPiece(2, 0, 0, "bishop", "white"), 2, 0);
-    addPiece(new ChessPiece(3, 0, 0, "queen", "white"), 3, 0);
-    addPiece(new ChessPiece(4, 0, 0, "king", "white"), 4, 0);
-    addPiece(new ChessPiece(5, 0, 0, "bishop", "white"), 5, 0);
-    addPiece(new ChessPiece(6, 0, 0, "knight", "white"), 6, 0);
-    addPiece(new ChessPiece(7, 0, 0, "rook", "white"), 7, 0);
-
-    for (int i = 0; i < 8; ++i) {
-        addPiece(new ChessPiece(i, 1, 0, "pawn", "white"), i, 1);
-    }
-
-    // Initialize the black pieces
-    addPiece(new ChessPiece(0, 7, 0, "rook", "black"), 0, 7);
-    addPiece(new ChessPiece(1, 7, 0, "knight", "black"), 1, 7);
-    addPiece(new ChessPiece(2, 7, 0, "bishop", "black"), 2, 7);
-    addPiece(new ChessPiece(3, 7, 0, "queen", "black"), 3, 7);
-    addPiece(new ChessPiece(4, 7, 0, "king", "black"), 4, 7);
-    addPiece(new ChessPiece(5, 7, 0, "bishop", "black"), 5, 7);
-    addPiece(new ChessPiece(6, 7, 0, "knight", "black"), 6, 7);
-    addPiece(new ChessPiece(7, 7, 0, "rook", "black"), 7, 7);
-
-    for (int i = 0; i < 8; ++i) {
-        addPiece(new ChessPiece(i, 6, 0, "pawn", "black"), i, 6);
-    }
+    setupPieces();
 }
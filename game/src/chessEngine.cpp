@@ -2,37 +2,121 @@
 
 using namespace std;
 
+/**
+ * @brief Client ID of the next Stockfish object, so several boards can share one engine pool.
+ */
+static atomic<int> nextClient(0);
+
+Stockfish::Stockfish(bool remote) : remoteProcessing(remote), depth(0), difficulty(0), pool(nullptr), client(nextClient++),
+    latestGeneration(0), stopping(false), newGamePending(false), ponderEnabled(true) {}
+
 Stockfish::~Stockfish() {
-    if (stockfishProcess) {
-        pclose(stockfishProcess);
+    {
+        lock_guard<mutex> lock(requestMutex);
+        stopping = true;
+        // Makes a running search stale, so it is stopped instead of finished
+        latestGeneration++;
+    }
+    requestReady.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    if (pool) {
+        EnginePoolStats stats = pool->getStats();
+        if (stats.ponderHits + stats.ponderMisses > 0) {
+            cout << "Ponder hit rate: " << int(getPonderHitRate() * 100) << "% ("
+                 << stats.ponderHits << "/" << stats.ponderHits + stats.ponderMisses << ")" << endl;
+        }
     }
 }
 
-void Stockfish::init() {
-    stockfishProcess = popen((filesystem::current_path() / "stockfish").string().c_str(), "r+");
-    if (!stockfishProcess) {
-        cerr << "Error starting Stockfish." << endl;
-        return;
+void Stockfish::init(EnginePool& pool) {
+    lock_guard<mutex> lock(requestMutex);
+    this->pool = &pool;
+    newGamePending = true;
+}
+
+MoveRequest Stockfish::requestMove(const Position& start, const vector<Move>& moves, SearchLimits limits) {
+    auto request = make_shared<MoveRequestState>();
+    request->start = start;
+    request->moves = moves;
+    request->position = start;
+    UndoInfo undo;
+    for (Move move : moves) {
+        request->position.makeMove(move, undo);
     }
-    sendCommand("uci");
-    sendCommand("setoption name UCI_LimitStrength value true");
+    request->limits = limits;
+    MoveRequest handle(request);
+    {
+        lock_guard<mutex> lock(requestMutex);
+        request->generation = ++latestGeneration;
+        // A request still waiting for the worker is superseded and answered right away
+        if (pendingRequest) {
+            pendingRequest->result.set_value(MOVE_NONE);
+        }
+        pendingRequest = request;
+        if (!worker.joinable()) {
+            worker = thread(&Stockfish::workerLoop, this);
+        }
+    }
+    requestReady.notify_one();
+    return handle;
 }
 
-void Stockfish::sendCommand(const string& command) {
-    fputs((command + "\n").c_str(), stockfishProcess);
-    fflush(stockfishProcess);
+void Stockfish::newGame() {
+    {
+        lock_guard<mutex> lock(requestMutex);
+        newGamePending = true;
+        latestGeneration++;
+    }
+    requestReady.notify_one();
 }
 
-string Stockfish::readResponse() {
-    char buffer[256];
-    string response;
-    while (fgets(buffer, sizeof(buffer), stockfishProcess)) {
-        response += buffer;
-        if (strstr(buffer, "bestmove")) {
-            break;
+bool Stockfish::isStale(const MoveRequestState& request) const {
+    return request.cancelled || request.generation != latestGeneration;
+}
+
+void Stockfish::workerLoop() {
+    while (true) {
+        shared_ptr<MoveRequestState> request;
+        bool newGame;
+        int skill;
+        {
+            unique_lock<mutex> lock(requestMutex);
+            requestReady.wait(lock, [this]() { return stopping || pendingRequest; });
+            if (stopping) {
+                if (pendingRequest) {
+                    pendingRequest->result.set_value(MOVE_NONE);
+                    pendingRequest = nullptr;
+                }
+                return;
+            }
+            request = pendingRequest;
+            pendingRequest = nullptr;
+            newGame = newGamePending;
+            newGamePending = false;
+            skill = difficulty;
         }
+
+        Move move = isStale(*request) ? MOVE_NONE : search(*request, newGame, skill);
+        request->result.set_value(isStale(*request) ? MOVE_NONE : move);
     }
-    return response;
+}
+
+Move Stockfish::search(const MoveRequestState& request, bool newGame, int skill) {
+    if (!remoteProcessing) {
+        return getMoveLocal(request, newGame, skill);
+    }
+    // The API speaks UCI text, so moves are only converted here
+    string move;
+    try {
+        move = getMoveRemote(request.position.fen());
+    } catch (exception& e) {
+        cerr << "Error processing move remotely: " << e.what() << endl;
+        return getMoveLocal(request, newGame, skill);
+    }
+    return parseUciMove(request.position, move);
 }
 
 void Stockfish::setDifficulty(int difficulty) {
@@ -41,57 +125,46 @@ void Stockfish::setDifficulty(int difficulty) {
         cerr << "Difficulty must be between 0 and 20!" << endl;
         cerr << "Defaulting to " << to_string(difficulty) << endl;
     }
+    lock_guard<mutex> lock(requestMutex);
     this->difficulty = difficulty;
-    sendCommand("setoption name Skill Level value " + to_string(difficulty));
 }
 
-string Stockfish::getMove(const string& boardPosition) {
-    if (remoteProcessing) {
-        try {
-            return getMoveRemote(boardPosition);
-        } catch (exception& e) {
-            cerr << "Error processing move remotely: " << e.what() << endl;
-            try {
-                return getMoveLocal(boardPosition);
-            } catch (exception& e) {
-                cerr << "Error processing move locally: " << e.what() << endl;
-                return "";
-            }
-        }
-    } else {
-        return getMoveLocal(boardPosition);
+SearchLimits Stockfish::searchLimits(SearchLimits limits) const {
+    if (limits.depth <= 0 && limits.moveTimeMs <= 0) {
+        limits.depth = depth;
     }
+    return limits;
 }
 
-string Stockfish::getMoveLocal(const string& boardPosition) {
-    sendCommand("position fen " + boardPosition);
-    sendCommand("go depth " + to_string(depth));
-
-    string response = readResponse();
-
-    if (response.find("bestmove") == string::npos) {
-        cerr << "Error: 'bestmove' not found in response: " << response << endl;
-        return "";
+Move Stockfish::getMoveLocal(const MoveRequestState& request, bool newGame, int skill) {
+    if (!pool) {
+        cerr << "Error processing move locally: no engine pool." << endl;
+        return MOVE_NONE;
     }
 
-    size_t bestMovePos = response.find("bestmove");
-    if (bestMovePos == string::npos || bestMovePos + 9 >= response.size()) {
-        cerr << "Error: 'bestmove' position is out of range in response: " << response << endl;
-        return "";
+    // The pool sends each option only when its value changed, and keeps pondering between this engine's moves
+    EngineJobOptions options;
+    options.uciOptions = {{"UCI_LimitStrength", "true"}, {"Ponder", "true"}, {"Skill Level", to_string(skill)}};
+    options.ponder = ponderEnabled;
+    options.newGame = newGame;
+    EngineJob job = pool->submit(client, request.start, request.moves, searchLimits(request.limits), options);
+    while (!job.ready()) {
+        if (isStale(request)) {
+            job.cancel();
+            break;
+        }
+        this_thread::sleep_for(chrono::milliseconds(ENGINE_POLL_MS));
     }
+    return job.get().move;
+}
 
-    string bestMoveStr = response.substr(bestMovePos + 9);
-    size_t spacePos = bestMoveStr.find(' ');
-    if (spacePos != string::npos) {
-        bestMoveStr = bestMoveStr.substr(0, spacePos);
-        if (bestMoveStr == "(none)") {
-            return "";
-        } else {
-            return bestMoveStr;
-        }
-    } else {
-        return bestMoveStr;
+double Stockfish::getPonderHitRate() const {
+    if (!pool) {
+        return 0.0;
     }
+    EnginePoolStats stats = pool->getStats();
+    uint64_t total = stats.ponderHits + stats.ponderMisses;
+    return total ? double(stats.ponderHits) / total : 0.0;
 }
 
 string Stockfish::getMoveRemote(const string& boardPosition) {
@@ -15,10 +15,10 @@ void ChessPiece::init() {
     darkGreyTexture = createColorTexture(glm::vec3(0.2f, 0.2f, 0.2f));
 }
 
-void ChessPiece::convertTo(const std::string& newType) {
+void ChessPiece::convertTo(PieceType newType) {
     this->type = newType;
     loadMesh();
-    pieceTexture = (player == "white") ? whiteTexture : blackTexture;
+    pieceTexture = (player == WHITE) ? whiteTexture : blackTexture;
     updateModelMatrix();
 }
 
@@ -27,30 +27,31 @@ void ChessPiece::setPosition(float x, float y, float z) {
     glm::vec3 a0(squareSize * 4, 0, -squareSize * 4);
     glm::vec3 piecePosition(-squareSize * x - squareSize / 2, 0, squareSize * y + squareSize / 2);
     this->position = a0 + piecePosition;
-    boardLocation = string(1, 'a' + x) + to_string(int(y + 1));
+    // Taken pieces stand beside the board and have no square
+    int file = int(x);
+    int rank = int(y);
+    boardLocation = (file >= 0 && file < 8 && rank >= 0 && rank < 8) ? squareName(makeSquare(file, rank)) : "";
     updateModelMatrix();
 }
 
 void ChessPiece::updateModelMatrix() {
     modelMatrix = glm::translate(glm::mat4(1.0f), position);
     // Rotate white pieces
-    if (player == "white") {
+    if (player == WHITE) {
         modelMatrix = glm::rotate(modelMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     }
 }
 
-ChessPiece::ChessPiece(float x, float y, float z, string type, string player) {
-    setPosition(x, y, z);
+ChessPiece::ChessPiece(float x, float y, float z, PieceType type, Color player) {
+    // The model matrix depends on the player, so it is set before the position
     this->type = type;
     this->player = player;
     hovered = false;
     hasMoved = false;
-    boardLocation = string(1, 'a' + x) + to_string(int(y + 1));
-    loadMesh();
-    pieceTexture = (player == "white") ? whiteTexture : blackTexture;
-    modelMatrix = glm::mat4(1.0f);
-    updateModelMatrix();
     taken = false;
+    setPosition(x, y, z);
+    loadMesh();
+    pieceTexture = (player == WHITE) ? whiteTexture : blackTexture;
 }
 
 glm::vec3 ChessPiece::getPosition() const {
@@ -66,9 +67,9 @@ void ChessPiece::loadMesh() {
     vector<glm::vec3> vertices;
     vector<glm::vec2> uvs;
     vector<glm::vec3> normals;
-    bool res = loadAssImp(("assets/models/" + type + ".obj").c_str(), indices, vertices, uvs, normals);
+    bool res = loadAssImp(("assets/models/" + string(pieceTypeName(type)) + ".obj").c_str(), indices, vertices, uvs, normals);
     if (!res) {
-        cerr << "Error loading " << type << " mesh!" << endl;
+        cerr << "Error loading " << pieceTypeName(type) << " mesh!" << endl;
         return;
     }
 
@@ -141,7 +142,7 @@ void ChessPiece::render() const {
     // Bind texture
     glActiveTexture(GL_TEXTURE0);
     GLuint useTexture;
-    if (player == "white") {
+    if (player == WHITE) {
         useTexture = (hovered && !taken) ? greyTexture : pieceTexture;
     } else {
         useTexture = (hovered && !taken) ? darkGreyTexture : pieceTexture;
@@ -165,7 +166,7 @@ void ChessPiece::animateMove(float x, float y, float z, bool& animating) {
         float t = static_cast<float>(i) / steps;
         glm::vec3 intermediatePosition = glm::mix(startPosition, adjustedEndPosition, t);
         // Knight moves in a curve
-        if (type == "knight") {
+        if (type == KNIGHT) {
             float height = 0.5f * sin(glm::pi<float>() * t);
             intermediatePosition.y += height;
         }
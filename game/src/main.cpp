@@ -38,10 +38,12 @@ int depth = 10;
 int difficulty = 10; // 0-20
 bool remote = false;
 atomic<bool> multiplayer = false;
-string playerColor = "white";
+Color playerColor = WHITE;
+EnginePool enginePool;
 Stockfish stockfish;
 ChessBoard board;
 atomic<bool> resetBoard = false;
+atomic<bool> moveRejected = false;
 
 /**
  * @brief Reads command line arguments.
@@ -257,7 +259,7 @@ int generalInit() {
     glBindVertexArray(0);
 
     // Set up camera
-    if (playerColor == "white") {
+    if (playerColor == WHITE) {
         camera = Camera(glm::vec3(0.0f, 3.0f, -2.5f), glm::vec3(0.0f, 0.0f, 0.0f), 90.0f, -50.0f);
     } else {
         camera = Camera(glm::vec3(0.0f, 3.0f, 2.5f), glm::vec3(0.0f, 0.0f, 0.0f), -90.0f, -50.0f);
@@ -268,17 +270,26 @@ int generalInit() {
 
     // Set up chess engine
     if (!remote) {
-        stockfish.init();
+        EngineOptions options;
+        options.path = (filesystem::current_path() / "stockfish").string();
+        options.depth = depth;
+        if (!enginePool.start(options, ENGINE_POOL_SIZE)) {
+            cerr << "Error starting Stockfish." << endl;
+        }
         stockfish.setDifficulty(difficulty);
     }
+    stockfish.init(enginePool);
     stockfish.setDepth(depth);
     stockfish.setRemoteProcessing(remote);
 
+    // Set up rules tables
+    initBitboards();
+
     // Set up chess pieces
     ChessPiece::init();
 
     // Set up chess board
-    board = ChessBoard(glm::vec3(0.0f, 0.0f, 0.0f));
+    board.init(glm::vec3(0.0f, 0.0f, 0.0f));
 
     return 0;
 }
@@ -316,9 +327,11 @@ void render(string overlayContent="") {
     glUniform1i(glGetUniformLocation(frameShaderProgram, "screenTexture"), 0);
     float aspectRatio = static_cast<float>(fbWidth) / static_cast<float>(fbHeight);
     glUniform1f(glGetUniformLocation(frameShaderProgram, "aspectRatio"), aspectRatio);
-    glUniform1i(glGetUniformLocation(frameShaderProgram, "playerInCheck"), board.inCheck(playerColor));
-    glUniform1i(glGetUniformLocation(frameShaderProgram, "playerMated"), board.checkMated(playerColor));
-    glUniform1i(glGetUniformLocation(frameShaderProgram, "opponentMated"), board.checkMated((playerColor == "white") ? "black" : "white"));
+    const GameStatus& status = board.getStatus();
+    bool playerToMove = status.sideToMove == playerColor;
+    glUniform1i(glGetUniformLocation(frameShaderProgram, "playerInCheck"), playerToMove && status.check);
+    glUniform1i(glGetUniformLocation(frameShaderProgram, "playerMated"), playerToMove && status.checkmate);
+    glUniform1i(glGetUniformLocation(frameShaderProgram, "opponentMated"), !playerToMove && status.checkmate);
     glUniform1i(glGetUniformLocation(frameShaderProgram, "gameRunning"), board.getGameRunning());
 
     // Overlay content if needed
@@ -373,7 +386,7 @@ int main(int argc, char* argv[]) {
     while (!glfwWindowShouldClose(window) ) {
         if (!board.getGameRunning() && glfwGetKey(window, GLFW_KEY_ENTER) == GLFW_PRESS) {
             board.startGame();
-            if (playerColor == "white") {
+            if (playerColor == WHITE) {
                 camera.setPositionAndOrientation(glm::vec3(0.0f, 3.0f, -2.5f), glm::vec3(0.0f, 0.0f, 0.0f), 90.0f, -50.0f);
             } else {
                 camera.setPositionAndOrientation(glm::vec3(0.0f, 3.0f, 2.5f), glm::vec3(0.0f, 0.0f, 0.0f), -90.0f, -50.0f);
@@ -381,10 +394,13 @@ int main(int argc, char* argv[]) {
             while (glfwGetKey(window, GLFW_KEY_ENTER) == GLFW_PRESS) {glfwPollEvents();}
             startSound.play();
         } else if (board.getGameRunning() && glfwGetKey(window, GLFW_KEY_ESCAPE ) == GLFW_PRESS) {
-            if (multiplayer) sendMove("reset");
+            if (multiplayer) sendReset();
             board.reset();
             while (glfwGetKey(window, GLFW_KEY_ESCAPE ) == GLFW_PRESS) {glfwPollEvents();}
             checkmateSound.play();
+        } else if (board.getGameRunning() && !multiplayer && glfwGetKey(window, GLFW_KEY_BACKSPACE) == GLFW_PRESS) {
+            board.takeBack();
+            while (glfwGetKey(window, GLFW_KEY_BACKSPACE) == GLFW_PRESS) {glfwPollEvents();}
         } else if (!board.getGameRunning() && glfwGetKey(window, GLFW_KEY_ESCAPE ) == GLFW_PRESS) {
             break;
         }
@@ -1,17 +1,17 @@
 #include "multiplayer.h"
 
 int clientSocket; // Socket for the client
-queue<string> opponentMoves; // Queue of opponent moves
+queue<Move> opponentMoves; // Queue of opponent moves
 mutex opponentMovesMutex; // Mutex for the opponent moves queue
 thread listenMultiplayerThread; // Thread to listen for opponent moves
 atomic<bool> listenForMove; // Flag to indicate if the client should listen for opponent moves
 
-string lookForOpponent() {
+Color lookForOpponent() {
     clientSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (clientSocket == -1) {
         cerr << "Failed to create clientSocket." << endl;
         multiplayer = false;
-        return "white";
+        return WHITE;
     }
 
     struct sockaddr_in serverAddress;
@@ -22,7 +22,7 @@ string lookForOpponent() {
     if (connect(clientSocket, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) < 0) {
         cerr << "Failed to connect to the server: " << strerror(errno) << endl;
         multiplayer = false;
-        return "white";
+        return WHITE;
     }
     cout << "Connected to server." << endl;
 
@@ -35,7 +35,7 @@ string lookForOpponent() {
         cerr << "Failed to receive color length from server." << endl;
         close(clientSocket);
         multiplayer = false;
-        return "white";
+        return WHITE;
     }
 
     color_length = ntohl(color_length);
@@ -49,12 +49,12 @@ string lookForOpponent() {
         cerr << "Server closed the connection before sending color assignment." << endl;
         close(clientSocket);
         multiplayer = false;
-        return "white";
+        return WHITE;
     } else {
         cerr << "Failed to receive color assignment from server: " << strerror(errno) << endl;
         close(clientSocket);
         multiplayer = false;
-        return "white";
+        return WHITE;
     }
 
     if (color == "white") {
@@ -71,7 +71,7 @@ string lookForOpponent() {
     listenForMove = true;
     listenMultiplayerThread = thread(listenForMultiplayerMove);
     listenMultiplayerThread.detach();
-    return color;
+    return (color == "black") ? BLACK : WHITE;
 }
 
 void listenForMultiplayerMove() {
@@ -89,8 +89,14 @@ void listenForMultiplayerMove() {
         }
 
         uint32_t move_length = ntohl(move_length_network);
+        if (move_length == 0 || move_length > sizeof(buffer) - 1) {
+            cerr << "Message of " << move_length << " bytes from server is too long." << endl;
+            close(clientSocket);
+            multiplayer = false;
+            break;
+        }
 
-        bytesReceived = recv(clientSocket, buffer, move_length, 0);
+        bytesReceived = recv(clientSocket, buffer, move_length, MSG_WAITALL);
         if (bytesReceived <= 0) {
             cout << "Connection closed by server or error receiving move." << endl;
             close(clientSocket);
@@ -98,51 +104,69 @@ void listenForMultiplayerMove() {
             break;
         }
 
+        // Moves arrive as their packed 16-bit value, other messages as text
+        if (bytesReceived == sizeof(uint16_t)) {
+            uint16_t raw;
+            memcpy(&raw, buffer, sizeof(raw));
+            Move move = Move::fromRaw(ntohs(raw));
+            {
+                lock_guard<mutex> lock(opponentMovesMutex);
+                opponentMoves.push(move);
+            }
+            cout << "Received move: " << move.toString() << endl;
+            continue;
+        }
+
         buffer[bytesReceived] = '\0';
 
         if (string(buffer) == "reset") {
             resetBoard = true;
-            continue;
+        } else if (string(buffer) == "illegal") {
+            cerr << "Server rejected the last move." << endl;
+            moveRejected = true;
+        } else {
+            cerr << "Unknown message from opponent: " << buffer << endl;
         }
-
-        {
-            lock_guard<mutex> lock(opponentMovesMutex);
-            opponentMoves.push(string(buffer));
-        }
-
-        cout << "Received move: " << buffer << endl;
     }
 }
 
-void sendMove(const string& move) {
-    cout << "Sending move: " << move << endl;
-    uint32_t move_length = htonl(move.size());
+/**
+ * @brief Sends a length-prefixed message to the opponent.
+ */
+static void sendMessage(const void* message, uint32_t length) {
+    uint32_t message_length = htonl(length);
 
-    if (send(clientSocket, &move_length, sizeof(move_length), 0) == -1) {
+    if (send(clientSocket, &message_length, sizeof(message_length), 0) == -1) {
         cerr << "Failed to send move length to server: " << strerror(errno) << endl;
         close(clientSocket);
         multiplayer = false;
         return;
     }
 
-    if (send(clientSocket, move.c_str(), move.size(), 0) == -1) {
+    if (send(clientSocket, message, length, 0) == -1) {
             cerr << "Failed to send move to server: " << strerror(errno) << endl;
             close(clientSocket);
             multiplayer = false;
     }
 }
 
-string getMultiplayerMove() {
-    string move;
-    while (move.empty()) {
-        {
-            lock_guard<mutex> lock(opponentMovesMutex);
-            while (!opponentMoves.empty()) {
-                move = opponentMoves.front();
-                opponentMoves.pop();
-            }
-        }
-        this_thread::sleep_for(chrono::milliseconds(100));
+void sendMove(Move move) {
+    cout << "Sending move: " << move.toString() << endl;
+    uint16_t raw = htons(move.raw());
+    sendMessage(&raw, sizeof(raw));
+}
+
+void sendReset() {
+    const string message = "reset";
+    sendMessage(message.c_str(), message.size());
+}
+
+Move getMultiplayerMove() {
+    Move move;
+    lock_guard<mutex> lock(opponentMovesMutex);
+    while (!opponentMoves.empty()) {
+        move = opponentMoves.front();
+        opponentMoves.pop();
     }
     return move;
 }
@@ -12,6 +12,10 @@
 #include <netinet/in.h>
 #include <netdb.h>
 #include <csignal>
+#include <algorithm>
+#include "position.h"
+#include "movegen.h"
+#include "gameStatus.h"
 
 using namespace std;
 
@@ -20,25 +24,100 @@ const int PORT = 12345;
 mutex queueMutex;
 queue<int> clientQueue;
 
-void handlePlayer(int sender, int receiver) {
+/**
+ * @struct Game
+ * @brief Position of a running game, shared by the threads of both players.
+ */
+struct Game {
+    mutex positionMutex; // Guards position and history
+    Position position; // Position after all moves forwarded so far
+    vector<Key> history; // Keys of all positions of the game by ply, for draws by repetition
+    mutex sendMutex; // Keeps the length and body of a message together when both threads send
+};
+
+/**
+ * @brief Puts the game back to the start position.
+ */
+void resetGame(Game& game) {
+    game.position.set(START_FEN);
+    game.history.assign(1, game.position.key());
+}
+
+/**
+ * @brief Checks a move sent by a player and plays it on the game position.
+ * @param game The game the move belongs to.
+ * @param player The side of the player who sent it.
+ * @param move The move.
+ * @return True if the move was legal and played, false otherwise.
+ */
+bool playMove(Game& game, Color player, Move move) {
+    lock_guard<mutex> lock(game.positionMutex);
+    if (game.position.sideToMove() != player) {
+        return false;
+    }
+    MoveList legalMoves;
+    generateLegalMoves(game.position, legalMoves);
+    if (find(legalMoves.begin(), legalMoves.end(), move) == legalMoves.end()) {
+        return false;
+    }
+    game.position.applyMove(move);
+    game.history.push_back(game.position.key());
+
+    // Both clients start a new game on their own once this one is over
+    if (computeGameStatus(game.position, game.history).gameOver()) {
+        resetGame(game);
+    }
+    return true;
+}
+
+/**
+ * @brief Sends a length-prefixed message to a player.
+ */
+void sendMessage(Game& game, int receiver, const void* message, uint32_t length) {
+    lock_guard<mutex> lock(game.sendMutex);
+    uint32_t lengthNetwork = htonl(length);
+    send(receiver, &lengthNetwork, sizeof(lengthNetwork), 0);
+    send(receiver, message, length, 0);
+}
+
+void handlePlayer(int sender, int receiver, Color player, Game* game) {
     char buffer[1024];
     while (true) {
         // Receive message length from source player
         uint32_t messageLengthNetwork;
-        ssize_t bytesRecieved = recv(sender, &messageLengthNetwork, sizeof(messageLengthNetwork), 0);
-        if (bytesRecieved <= 0) break;
+        ssize_t bytesRecieved = recv(sender, &messageLengthNetwork, sizeof(messageLengthNetwork), MSG_WAITALL);
+        if (bytesRecieved != sizeof(messageLengthNetwork)) break;
 
         uint32_t messageLength = ntohl(messageLengthNetwork);
+        if (messageLength == 0 || messageLength > sizeof(buffer) - 1) {
+            cerr << "Message of " << messageLength << " bytes from " << colorName(player) << " is too long." << endl;
+            break;
+        }
 
         // Receive the actual message from source player
-        bytesRecieved = recv(sender, buffer, messageLength, 0);
-        if (bytesRecieved <= 0) break;
+        bytesRecieved = recv(sender, buffer, messageLength, MSG_WAITALL);
+        if (bytesRecieved != ssize_t(messageLength)) break;
         buffer[bytesRecieved] = '\0';
 
-        // Forward the message length to destination player
-        send(receiver, &messageLengthNetwork, sizeof(messageLengthNetwork), 0);
-        // Forward the actual message to destination player
-        send(receiver, buffer, messageLength, 0);
+        // Moves are two byte messages, anything else is a command such as "reset"
+        if (messageLength == sizeof(uint16_t)) {
+            uint16_t raw;
+            memcpy(&raw, buffer, sizeof(raw));
+            Move move = Move::fromRaw(ntohs(raw));
+            if (!playMove(*game, player, move)) {
+                // The sender already played the move on its board, so it is told to take it back
+                cerr << "Rejected illegal move " << move.toString() << " from " << colorName(player) << "." << endl;
+                const string rejection = "illegal";
+                sendMessage(*game, sender, rejection.c_str(), rejection.size());
+                continue;
+            }
+        } else if (string(buffer) == "reset") {
+            lock_guard<mutex> lock(game->positionMutex);
+            resetGame(*game);
+        }
+
+        // Forward the message to destination player
+        sendMessage(*game, receiver, buffer, messageLength);
     }
 
     close(sender);
@@ -62,9 +141,12 @@ void startGame(int client1, int client2) {
     send(client2, &color2_length, sizeof(color2_length), 0);
     send(client2, color2_msg.c_str(), color2_msg.size(), 0);
 
+    Game game;
+    resetGame(game);
+
     // Threads for handling communication between each player
-    thread client1Thread(handlePlayer, client1, client2);
-    thread client2Thread(handlePlayer, client2, client1);
+    thread client1Thread(handlePlayer, client1, client2, Color(color1), &game);
+    thread client2Thread(handlePlayer, client2, client1, Color(color2), &game);
 
     client1Thread.join();
     client2Thread.join();
@@ -152,6 +234,7 @@ void signalHandler(int signum) {
 int main() {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
+    initBitboards();
     
     serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket == -1) {